@@ -36,7 +36,7 @@ ChargingGrant::ChargingGrant(const StoredChargingGrant& marshaled) {
   suspended      = marshaled.suspended;
 }
 
-StoredChargingGrant ChargingGrant::marshal() {
+StoredChargingGrant ChargingGrant::marshal() & {
   StoredChargingGrant marshaled{};
   marshaled.is_final                       = is_final_grant;
   marshaled.final_action_info.final_action = final_action_info.final_action;
@@ -51,6 +51,22 @@ StoredChargingGrant ChargingGrant::marshal() {
   return marshaled;
 }
 
+StoredChargingGrant ChargingGrant::marshal() && {
+  StoredChargingGrant marshaled{};
+  marshaled.is_final                       = is_final_grant;
+  marshaled.final_action_info.final_action = final_action_info.final_action;
+  marshaled.final_action_info.redirect_server =
+      std::move(final_action_info.redirect_server);
+  marshaled.final_action_info.restrict_rules =
+      std::move(final_action_info.restrict_rules);
+  marshaled.reauth_state  = reauth_state;
+  marshaled.service_state = service_state;
+  marshaled.expiry_time   = expiry_time;
+  marshaled.credit        = std::move(credit).marshal();
+  marshaled.suspended     = suspended;
+  return marshaled;
+}
+
 CreditValidity ChargingGrant::is_valid_credit_response(
     const CreditUpdateResponse& update) {
   const uint32_t key             = update.charging_key();
@@ -209,10 +225,14 @@ bool ChargingGrant::get_update_type(
 }
 
 bool ChargingGrant::should_deactivate_service() const {
+  return should_deactivate_service(
+      is_final_grant && credit.is_quota_exhausted(1));
+}
+
+bool ChargingGrant::should_deactivate_service(bool quota_exhausted) const {
   const bool final_action_is_terminate =
       final_action_info.final_action == ChargingCredit_FinalAction_TERMINATE;
-  const bool is_final_and_credit_exhausted =
-      is_final_grant && credit.is_quota_exhausted(1);
+  const bool is_final_and_credit_exhausted = is_final_grant && quota_exhausted;
 
   if (!is_final_and_credit_exhausted) {
     return false;
@@ -49,7 +49,7 @@ struct ChargingGrant {
   // indicates the rules have been removed from pipelined
   bool suspended;
 
-  const uint32_t REDIRECT_FLOW_PRIORITY = 2000;
+  static constexpr uint32_t REDIRECT_FLOW_PRIORITY = 2000;
 
   // Default states
   ChargingGrant()
@@ -62,7 +62,11 @@ struct ChargingGrant {
   explicit ChargingGrant(const StoredChargingGrant& marshaled);
 
   // ChargingGrant -> StoredChargingGrant
-  StoredChargingGrant marshal();
+  StoredChargingGrant marshal() &;
+
+  // Rvalue overload used by SessionState::marshal_move: moves the credit and
+  // final action info instead of copying them
+  StoredChargingGrant marshal() &&;
 
   void receive_charging_grant(
       const CreditUpdateResponse& update,
@@ -109,6 +113,10 @@ struct ChargingGrant {
   //    3b. For FUA-redirect/restrict, deactivate if not already deactivated
   bool should_deactivate_service() const;
 
+  // Same check with the (final) quota-exhaustion result already in hand, for
+  // callers that have just evaluated is_quota_exhausted(1) themselves
+  bool should_deactivate_service(bool quota_exhausted) const;
+
   // Convert FinalAction enum to ServiceActionType
   ServiceActionType final_action_to_action(
       const ChargingCredit_FinalAction action) const;
@@ -103,7 +103,11 @@ inline std::ostream& operator<<(std::ostream& s, const CreditKey& k) {
   return s;
 }
 
-inline size_t ccHash(const CreditKey& k) {
+// Hashing a CreditKey is a couple of integer ops (std::hash over uint32_t is
+// the identity on the supported toolchains), so the key deliberately does not
+// carry a cached hash member; a map probe is already cheaper than the extra
+// 8 bytes per key would be.
+inline size_t ccHash(const CreditKey& k) noexcept {
   static const int ccHashShift = sizeof(size_t) > sizeof(uint32_t) ? 32 : 1;
   size_t res = std::hash<uint32_t>()(k.rating_group) << ccHashShift;
   if (k.service_identifier) {
@@ -112,7 +116,7 @@ inline size_t ccHash(const CreditKey& k) {
   return res;
 };
 
-inline bool ccEqual(const CreditKey& l, const CreditKey& r) {
+inline bool ccEqual(const CreditKey& l, const CreditKey& r) noexcept {
   return (l.rating_group == r.rating_group) &&
          ((!l.service_identifier) ||
           (l.service_identifier == r.service_identifier));
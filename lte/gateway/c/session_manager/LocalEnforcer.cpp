@@ -18,6 +18,7 @@
 #include <lte/protos/session_manager.pb.h>
 #include <time.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -43,7 +44,7 @@ using namespace std::placeholders;
 static void handle_command_level_result_code_for_monitors(
     const std::string& imsi, const std::string& session_id,
     const uint32_t result_code,
-    std::unordered_set<ImsiAndSessionID>& sessions_to_terminate);
+    ImsiAndSessionIDSet& sessions_to_terminate);
 
 static bool is_valid_mac_address(const char* mac);
 
@@ -64,19 +65,19 @@ LocalEnforcer::LocalEnforcer(
     long session_force_termination_timeout_ms,
     long quota_exhaustion_termination_on_init_ms,
     magma::mconfig::SessionD mconfig)
-    : reporter_(reporter),
-      rule_store_(rule_store),
-      pipelined_client_(pipelined_client),
-      events_reporter_(events_reporter),
-      spgw_client_(spgw_client),
-      aaa_client_(aaa_client),
+    : reporter_(std::move(reporter)),
+      rule_store_(std::move(rule_store)),
+      pipelined_client_(std::move(pipelined_client)),
+      events_reporter_(std::move(events_reporter)),
+      spgw_client_(std::move(spgw_client)),
+      aaa_client_(std::move(aaa_client)),
       session_store_(session_store),
       session_force_termination_timeout_ms_(
           session_force_termination_timeout_ms),
       quota_exhaustion_termination_on_init_ms_(
           quota_exhaustion_termination_on_init_ms),
       retry_timeout_(2000),
-      mconfig_(mconfig),
+      mconfig_(std::move(mconfig)),
       access_timezone_(compute_access_timezone()) {}
 
 void LocalEnforcer::start() {
@@ -85,6 +86,7 @@ void LocalEnforcer::start() {
 
 void LocalEnforcer::attachEventBase(folly::EventBase* evb) {
   evb_ = evb;
+  timer_wheel_.attach(evb);
 }
 
 void LocalEnforcer::stop() {
@@ -95,6 +97,54 @@ folly::EventBase& LocalEnforcer::get_event_base() {
   return *evb_;
 }
 
+void RuleTimerWheel::attach(folly::EventBase* evb) {
+  evb_ = evb;
+  schedule_tick();
+}
+
+void RuleTimerWheel::schedule_tick() {
+  evb_->runAfterDelay(
+      [this] {
+        tick();
+        schedule_tick();
+      },
+      1000);
+}
+
+void RuleTimerWheel::insert(
+    std::chrono::milliseconds delay, std::function<void()> cb) {
+  if (delay.count() < 1000) {
+    evb_->runAfterDelay(std::move(cb), delay.count());
+    return;
+  }
+  // Round the delay up to whole ticks and add one more for the partial tick
+  // already in flight: the first tick after insert can land almost
+  // immediately, and scheduled rule changes must never run before their
+  // PCRF-given time. The callback may be late by up to a tick, never early.
+  const size_t ticks = (delay.count() + 999) / 1000 + 1;
+  auto& slot         = slots_[(cursor_ + ticks) % kSlots];
+  // The target slot is reached after ticks % kSlots ticks, so a delay of
+  // exactly N full wheel revolutions must wait N - 1 further passes over the
+  // slot, not N
+  slot.push_back(
+      PendingTimer{static_cast<uint32_t>((ticks - 1) / kSlots), std::move(cb)});
+}
+
+void RuleTimerWheel::tick() {
+  cursor_     = (cursor_ + 1) % kSlots;
+  auto& slot  = slots_[cursor_];
+  size_t kept = 0;
+  for (size_t i = 0; i < slot.size(); i++) {
+    if (slot[i].rounds_left == 0) {
+      slot[i].cb();
+    } else {
+      slot[i].rounds_left--;
+      slot[kept++] = std::move(slot[i]);
+    }
+  }
+  slot.resize(kept);
+}
+
 void LocalEnforcer::setup(
     SessionMap& session_map, const std::uint64_t& epoch,
     std::function<void(Status status, SetupFlowsResult)> callback) {
@@ -177,7 +227,7 @@ void LocalEnforcer::sync_sessions_on_restart(std::time_t current_time) {
 
       session->sync_rules_to_time(current_time, &session_uc);
 
-      for (std::string rule_id : session->get_static_rules()) {
+      for (const std::string& rule_id : session->get_static_rules()) {
         auto lifetime = session->get_rule_lifetime(rule_id);
         if (lifetime.deactivation_time > current_time) {
           auto rule_install =
@@ -187,7 +237,7 @@ void LocalEnforcer::sync_sessions_on_restart(std::time_t current_time) {
         }
       }
       // Schedule rule activations / deactivations
-      for (std::string rule_id : session->get_scheduled_static_rules()) {
+      for (const std::string& rule_id : session->get_scheduled_static_rules()) {
         auto lifetime = session->get_rule_lifetime(rule_id);
         schedule_static_rule_activation(
             imsi, session_id, rule_id, lifetime.activation_time);
@@ -199,7 +249,7 @@ void LocalEnforcer::sync_sessions_on_restart(std::time_t current_time) {
 
       std::vector<std::string> rule_ids;
       session->get_dynamic_rules().get_rule_ids(rule_ids);
-      for (std::string rule_id : rule_ids) {
+      for (const std::string& rule_id : rule_ids) {
         auto lifetime = session->get_rule_lifetime(rule_id);
         if (lifetime.deactivation_time > current_time) {
           auto rule_install =
@@ -210,7 +260,7 @@ void LocalEnforcer::sync_sessions_on_restart(std::time_t current_time) {
       }
       rule_ids.clear();
       session->get_scheduled_dynamic_rules().get_rule_ids(rule_ids);
-      for (auto rule_id : rule_ids) {
+      for (const std::string& rule_id : rule_ids) {
         auto lifetime = session->get_rule_lifetime(rule_id);
         auto rule_install =
             session->get_dynamic_rule_install(rule_id, lifetime);
@@ -236,23 +286,37 @@ void LocalEnforcer::sync_sessions_on_restart(std::time_t current_time) {
 void LocalEnforcer::aggregate_records(
     SessionMap& session_map, const RuleRecordTable& records,
     SessionUpdate& session_update) {
-  // Insert the IMSI+SessionID for sessions we received a rule record into a set
-  // for easy access
-  std::unordered_set<ImsiAndSessionID> sessions_with_reporting_flows;
+  // Insert the IMSI+SessionID for sessions we received a rule record into a
+  // set for easy access
+  ImsiAndSessionIDSet sessions_with_reporting_flows;
   // In some failure cases, PipelineD may still hold onto flows for sessions
   // that do not exist in SessionD. In this case, send DeactivateFlowsRequest
   RuleRecordSet dead_sessions_to_cleanup;
 
+  // Consecutive records for the same subscriber are very common, so keep a
+  // one-entry cache of the last (IMSI, IP) -> session lookup to skip the
+  // SessionMap probe on the hot case
+  const std::string* last_imsi = nullptr;
+  const std::string* last_ip   = nullptr;
+  optional<SessionVector::iterator> last_session_it;
   for (const RuleRecord& record : records.records()) {
     const std::string &imsi = record.sid(), &ip = record.ue_ipv4();
-    // TODO IPv6 add ipv6 to search criteria
-    SessionSearchCriteria criteria(imsi, IMSI_AND_UE_IPV4_OR_IPV6, ip);
-    auto session_it = session_store_.find_session(session_map, criteria);
-    if (!session_it) {
-      MLOG(MERROR) << "Could not find an active session for " << imsi << " and "
-                   << ip << " during record aggregation";
-      dead_sessions_to_cleanup.insert(record);
-      continue;
+    optional<SessionVector::iterator> session_it;
+    if (last_session_it && *last_imsi == imsi && *last_ip == ip) {
+      session_it = last_session_it;
+    } else {
+      // TODO IPv6 add ipv6 to search criteria
+      SessionSearchCriteria criteria(imsi, IMSI_AND_UE_IPV4_OR_IPV6, ip);
+      session_it = session_store_.find_session(session_map, criteria);
+      if (!session_it) {
+        MLOG(MERROR) << "Could not find an active session for " << imsi
+                     << " and " << ip << " during record aggregation";
+        dead_sessions_to_cleanup.insert(record);
+        continue;
+      }
+      last_imsi       = &imsi;
+      last_ip         = &ip;
+      last_session_it = session_it;
     }
 
     auto& session                 = **session_it;
@@ -305,22 +369,21 @@ void LocalEnforcer::cleanup_dead_sessions(
 
 void LocalEnforcer::complete_termination_for_released_sessions(
     SessionMap& session_map,
-    std::unordered_set<ImsiAndSessionID> sessions_with_reporting_flows,
+    const ImsiAndSessionIDSet& sessions_with_reporting_flows,
     SessionUpdate& session_update) {
   // Iterate through sessions and notify that report has finished. Terminate any
   // sessions that can be terminated.
   std::vector<ImsiAndSessionID> sessions_to_terminate;
   for (const auto& session_pair : session_map) {
-    const std::string imsi = session_pair.first;
+    const std::string& imsi = session_pair.first;
     for (const auto& session : session_pair.second) {
       const std::string session_id = session->get_session_id();
       // If we did not receive a rule record for the session, this means
       // PipelineD has reported all usage for the session
-      auto imsi_and_session_id = ImsiAndSessionID(imsi, session_id);
       if (session->get_state() == SESSION_RELEASED &&
-          sessions_with_reporting_flows.find(imsi_and_session_id) ==
-              sessions_with_reporting_flows.end()) {
-        sessions_to_terminate.push_back(imsi_and_session_id);
+          sessions_with_reporting_flows.find(ImsiAndSessionID(
+              imsi, session_id)) == sessions_with_reporting_flows.end()) {
+        sessions_to_terminate.push_back(ImsiAndSessionID(imsi, session_id));
       }
     }
   }
@@ -371,33 +434,31 @@ void LocalEnforcer::handle_activate_service_action(
                     ip_addr   = action_p->get_ip_addr(),
                     ipv6_addr = action_p->get_ipv6_addr();
   const Teids teids           = action_p->get_teids();
-  const auto ambr             = action_p->get_ambr();
-  RulesToProcess to_process   = action_p->get_gx_rules_to_install();
+  const auto& ambr            = action_p->get_ambr();
+  const RulesToProcess& to_process = action_p->get_gx_rules_to_install();
   pipelined_client_->activate_flows_for_rules(
       imsi, ip_addr, ipv6_addr, teids, msisdn, ambr, to_process,
-      std::bind(
-          &LocalEnforcer::handle_activate_ue_flows_callback, this, imsi,
-          ip_addr, ipv6_addr, teids, _1, _2));
+      ActivateFlowsCallback(this, imsi, ip_addr, ipv6_addr, teids));
 }
 
 // Terminates sessions that correspond to the given IMSI and session.
 void LocalEnforcer::start_session_termination(
-    const std::unique_ptr<SessionState>& session, bool notify_access,
+    SessionState& session, bool notify_access,
     SessionStateUpdateCriteria* session_uc) {
-  const std::string& imsi       = session->get_imsi();
-  const std::string& session_id = session->get_session_id();
-  if (session->is_terminating()) {
+  const std::string& imsi       = session.get_imsi();
+  const std::string& session_id = session.get_session_id();
+  if (session.is_terminating()) {
     // If the session is terminating already, do nothing.
     MLOG(MINFO) << "Session " << session_id << " is already terminating, "
                 << "ignoring termination request";
     return;
   }
   MLOG(MINFO) << "Initiating session termination for " << session_id;
-  session->set_pdp_end_time(magma::get_time_in_sec_since_epoch(), session_uc);
+  session.set_pdp_end_time(magma::get_time_in_sec_since_epoch(), session_uc);
 
   remove_all_rules_for_termination(session, session_uc);
-  session->set_fsm_state(SESSION_RELEASED, session_uc);
-  const auto& config         = session->get_config();
+  session.set_fsm_state(SESSION_RELEASED, session_uc);
+  const auto& config         = session.get_config();
   const auto& common_context = config.common_context;
   if (notify_access) {
     notify_termination_to_access_service(session_id, config);
@@ -410,7 +471,7 @@ void LocalEnforcer::start_session_termination(
   }
   if (terminate_on_wallet_exhaust()) {
     handle_subscriber_quota_state_change(
-        *session, SubscriberQuotaUpdate_Type_TERMINATE, session_uc);
+        session, SubscriberQuotaUpdate_Type_TERMINATE, session_uc);
   }
   // The termination should be completed when aggregated usage record no
   // longer
@@ -418,11 +479,11 @@ void LocalEnforcer::start_session_termination(
   // terminate the session.
   MLOG(MDEBUG) << "Scheduling a force termination timeout for " << session_id
                << " in " << session_force_termination_timeout_ms_ << "ms";
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      std::chrono::milliseconds(session_force_termination_timeout_ms_),
       [this, imsi, session_id] {
         handle_force_termination_timeout(imsi, session_id);
-      },
-      session_force_termination_timeout_ms_);
+      });
 }
 
 void LocalEnforcer::handle_force_termination_timeout(
@@ -450,15 +511,15 @@ void LocalEnforcer::handle_force_termination_timeout(
 }
 
 void LocalEnforcer::remove_all_rules_for_termination(
-    const std::unique_ptr<SessionState>& session,
+    SessionState& session,
     SessionStateUpdateCriteria* session_uc) {
-  const std::string ip_addr = session->get_config().common_context.ue_ipv4();
-  const auto ipv6_addr      = session->get_config().common_context.ue_ipv6();
-  const std::vector<Teids> teids = session->get_active_teids();
+  const std::string ip_addr = session.get_config().common_context.ue_ipv4();
+  const auto ipv6_addr      = session.get_config().common_context.ue_ipv6();
+  const std::vector<Teids> teids = session.get_active_teids();
   pipelined_client_->deactivate_flows_for_rules_for_termination(
-      session->get_imsi(), ip_addr, ipv6_addr, teids,
+      session.get_imsi(), ip_addr, ipv6_addr, teids,
       RequestOriginType::WILDCARD);
-  session->remove_all_rules_for_termination(session_uc);
+  session.remove_all_rules_for_termination(session_uc);
 }
 
 void LocalEnforcer::notify_termination_to_access_service(
@@ -494,14 +555,13 @@ void LocalEnforcer::notify_termination_to_access_service(
 void LocalEnforcer::handle_subscriber_quota_state_change(
     SessionState& session, SubscriberQuotaUpdate_Type new_state,
     SessionStateUpdateCriteria* session_uc) {
-  auto config                   = session.get_config();
   const std::string& imsi       = session.get_imsi();
   const std::string& session_id = session.get_session_id();
   MLOG(MINFO) << session_id << " now has subscriber wallet status: "
               << wallet_state_to_str(new_state);
   session.set_subscriber_quota_state(new_state, session_uc);
   std::string ue_mac_addr = "";
-  auto rat_specific       = config.rat_specific_context;
+  const auto& rat_specific = session.get_config().rat_specific_context;
   if (rat_specific.has_wlan_context()) {
     ue_mac_addr = rat_specific.wlan_context().mac_addr();
   }
@@ -510,18 +570,18 @@ void LocalEnforcer::handle_subscriber_quota_state_change(
 
 void LocalEnforcer::install_final_unit_action_flows(
     const std::unique_ptr<ServiceAction>& action_p) {
-  const std::string imsi       = action_p->get_imsi(),
-                    msisdn     = action_p->get_msisdn(),
-                    ip_addr    = action_p->get_ip_addr(),
-                    ipv6_addr  = action_p->get_ipv6_addr(),
-                    session_id = action_p->get_session_id();
+  const std::string &imsi = action_p->get_imsi(),
+                    &msisdn = action_p->get_msisdn(),
+                    &ip_addr = action_p->get_ip_addr(),
+                    &ipv6_addr = action_p->get_ipv6_addr(),
+                    &session_id = action_p->get_session_id();
   const Teids teids            = action_p->get_teids();
   const auto fua_type          = action_p->get_type();
 
   MLOG(MINFO) << "Installing final unit action "
               << service_action_type_to_str(fua_type) << " flows for "
               << session_id;
-  RulesToProcess to_process = action_p->get_gy_rules_to_install();
+  const RulesToProcess& to_process = action_p->get_gy_rules_to_install();
   pipelined_client_->add_gy_final_action_flow(
       imsi, ip_addr, ipv6_addr, teids, msisdn, to_process);
 }
@@ -566,11 +626,14 @@ void LocalEnforcer::handle_update_failure(
  * installed with quota
  */
 static bool should_activate(
-    const PolicyRule& rule,
-    const std::unordered_set<uint32_t>& successful_credits, bool online) {
+    const PolicyRule& rule, const ChargingCreditSet& successful_credits,
+    bool online) {
   if (online && (rule.tracking_type() == PolicyRule::ONLY_OCS ||
                  rule.tracking_type() == PolicyRule::OCS_AND_PCRF)) {
-    const bool exists = successful_credits.count(rule.rating_group()) > 0;
+    const bool exists =
+        std::find(
+            successful_credits.begin(), successful_credits.end(),
+            rule.rating_group()) != successful_credits.end();
     if (!exists) {
       MLOG(MERROR) << "Not activating Gy tracked " << rule.id()
                    << " because credit w/ rating group " << rule.rating_group()
@@ -622,7 +685,8 @@ void LocalEnforcer::schedule_static_rule_activation(
   MLOG(MDEBUG) << "Scheduling " << session_id << " static rule " << rule_id
                << " activation in " << (delta.count() / 1000) << " secs";
 
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      delta,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -665,13 +729,10 @@ void LocalEnforcer::schedule_static_rule_activation(
 
         pipelined_client_->activate_flows_for_rules(
             imsi, ip_addr, ipv6_addr, teids, msisdn, ambr, to_process,
-            std::bind(
-                &LocalEnforcer::handle_activate_ue_flows_callback, this, imsi,
-                ip_addr, ipv6_addr, teids, _1, _2));
+            ActivateFlowsCallback(this, imsi, ip_addr, ipv6_addr, teids));
 
         session_store_.update_sessions(session_update);
-      },
-      delta.count());
+      });
 }
 
 void LocalEnforcer::schedule_dynamic_rule_activation(
@@ -680,7 +741,8 @@ void LocalEnforcer::schedule_dynamic_rule_activation(
   auto delta = magma::time_difference_from_now(activation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " dynamic rule " << rule_id
                << " activation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      delta,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -725,13 +787,10 @@ void LocalEnforcer::schedule_dynamic_rule_activation(
 
         pipelined_client_->activate_flows_for_rules(
             imsi, ip_addr, ipv6_addr, teids, msisdn, ambr, to_process,
-            std::bind(
-                &LocalEnforcer::handle_activate_ue_flows_callback, this, imsi,
-                ip_addr, ipv6_addr, teids, _1, _2));
+            ActivateFlowsCallback(this, imsi, ip_addr, ipv6_addr, teids));
 
         session_store_.update_sessions(session_update);
-      },
-      delta.count());
+      });
 }
 
 void LocalEnforcer::schedule_static_rule_deactivation(
@@ -740,7 +799,8 @@ void LocalEnforcer::schedule_static_rule_deactivation(
   auto delta = magma::time_difference_from_now(deactivation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " static rule " << rule_id
                << " deactivation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      delta,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -781,8 +841,7 @@ void LocalEnforcer::schedule_static_rule_deactivation(
             imsi, ip_addr, ipv6_addr, teids, to_process, RequestOriginType::GX);
 
         session_store_.update_sessions(session_update);
-      },
-      delta.count());
+      });
 }
 
 void LocalEnforcer::schedule_dynamic_rule_deactivation(
@@ -791,7 +850,8 @@ void LocalEnforcer::schedule_dynamic_rule_deactivation(
   auto delta = magma::time_difference_from_now(deactivation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " dynamic rule " << rule_id
                << " deactivation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      delta,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -823,49 +883,55 @@ void LocalEnforcer::schedule_dynamic_rule_deactivation(
               RequestOriginType::GX);
         }
         session_store_.update_sessions(session_update);
-      },
-      delta.count());
+      });
 }
 
 void LocalEnforcer::filter_rule_installs(
-    bool online, std::vector<StaticRuleInstall>& static_installs,
-    std::vector<DynamicRuleInstall>& dynamic_installs,
-    const std::unordered_set<uint32_t>& successful_credits) {
-  // Filter out static rules that we will not install nor schedule
-
-  auto end_of_valid_st_rules = std::remove_if(
-      static_installs.begin(), static_installs.end(),
-      [&](StaticRuleInstall& rule_install) {
-        auto& id = rule_install.rule_id();
-        PolicyRule rule;
-        if (!rule_store_->get_rule(id, &rule)) {
-          LOG(ERROR) << "Not activating rule " << id
-                     << " because it could not be found";
-          return true;
-        }
-        return !should_activate(rule, successful_credits, online);
-      });
-  static_installs.erase(end_of_valid_st_rules, static_installs.end());
+    bool online,
+    google::protobuf::RepeatedPtrField<StaticRuleInstall>& static_installs,
+    google::protobuf::RepeatedPtrField<DynamicRuleInstall>& dynamic_installs,
+    const ChargingCreditSet& successful_credits) {
+  // Filter out static rules that we will not install nor schedule.
+  // SwapElements + DeleteSubrange compacts the repeated field with pointer
+  // swaps instead of copying message contents.
+  int kept = 0;
+  for (int i = 0; i < static_installs.size(); i++) {
+    const auto& id = static_installs.Get(i).rule_id();
+    std::shared_ptr<const PolicyRule> rule = rule_store_->get_rule_ptr(id);
+    if (rule == nullptr) {
+      LOG(ERROR) << "Not activating rule " << id
+                 << " because it could not be found";
+      continue;
+    }
+    if (should_activate(*rule, successful_credits, online)) {
+      static_installs.SwapElements(i, kept++);
+    }
+  }
+  static_installs.DeleteSubrange(kept, static_installs.size() - kept);
 
   // Filter out dynamic rules that we will not install nor schedule
-  auto end_of_valid_dy_rules = std::remove_if(
-      dynamic_installs.begin(), dynamic_installs.end(),
-      [&](DynamicRuleInstall& rule_install) {
-        return !should_activate(
-            rule_install.policy_rule(), successful_credits, online);
-      });
-  dynamic_installs.erase(end_of_valid_dy_rules, dynamic_installs.end());
+  kept = 0;
+  for (int i = 0; i < dynamic_installs.size(); i++) {
+    if (should_activate(
+            dynamic_installs.Get(i).policy_rule(), successful_credits,
+            online)) {
+      dynamic_installs.SwapElements(i, kept++);
+    }
+  }
+  dynamic_installs.DeleteSubrange(kept, dynamic_installs.size() - kept);
 }
 
 void LocalEnforcer::handle_session_activate_rule_updates(
     SessionState& session, const CreateSessionResponse& response,
-    std::unordered_set<uint32_t>& charging_credits_received) {
+    ChargingCreditSet& charging_credits_received) {
   RulesToProcess pending_activation, pending_deactivation, pending_bearer_setup;
   RulesToSchedule pending_scheduling;
-  std::vector<StaticRuleInstall> static_rule_installs =
-      to_vec(response.static_rules());
-  std::vector<DynamicRuleInstall> dynamic_rule_installs =
-      to_vec(response.dynamic_rules());
+  // Filtering mutates the list, so this is the one path that still copies the
+  // repeated fields (message pointers are swapped, not message bodies)
+  google::protobuf::RepeatedPtrField<StaticRuleInstall> static_rule_installs =
+      response.static_rules();
+  google::protobuf::RepeatedPtrField<DynamicRuleInstall> dynamic_rule_installs =
+      response.dynamic_rules();
   filter_rule_installs(
       response.online(), static_rule_installs, dynamic_rule_installs,
       charging_credits_received);
@@ -922,10 +988,15 @@ bool LocalEnforcer::update_tunnel_ids(
   session->set_teids(request.enb_teid(), request.agw_teid());
   const CreateSessionResponse& csr = session->get_create_session_response();
 
-  std::unordered_set<uint32_t> charging_credits_received;
+  ChargingCreditSet charging_credits_received;
   for (const auto& credit : csr.credits()) {
     if (session->receive_charging_credit(credit, nullptr)) {
-      charging_credits_received.insert(credit.charging_key());
+      if (std::find(
+              charging_credits_received.begin(),
+              charging_credits_received.end(),
+              credit.charging_key()) == charging_credits_received.end()) {
+        charging_credits_received.push_back(credit.charging_key());
+      }
     }
   }
   // We don't have to check 'success' field for monitors because command level
@@ -938,7 +1009,11 @@ bool LocalEnforcer::update_tunnel_ids(
   handle_session_activate_rule_updates(
       *session, csr, charging_credits_received);
 
-  update_ipfix_flow(imsi, session->get_config(), time_since_epoch);
+  // Check the flag here too so we skip the whole call when IPFIX export is
+  // off
+  if (LocalEnforcer::SEND_IPFIX) {
+    update_ipfix_flow(imsi, session->get_config(), time_since_epoch);
+  }
   if (terminate_on_wallet_exhaust()) {
     handle_session_activate_subscriber_quota_state(*session);
   }
@@ -974,7 +1049,7 @@ bool LocalEnforcer::update_tunnel_ids(
             }
             auto& session = **session_it;
             remove_rules_for_suspended_credit(
-                session, credit.charging_key(), nullptr);
+                *session, credit.charging_key(), nullptr);
           },
           500);
     }
@@ -1023,7 +1098,7 @@ void LocalEnforcer::handle_session_activate_subscriber_quota_state(
     MLOG(MINFO) << "Scheduling session for session " << session_id
                 << " to be terminated in "
                 << quota_exhaustion_termination_on_init_ms_ << " ms";
-    auto sessions_to_terminate = std::unordered_set<ImsiAndSessionID>{
+    auto sessions_to_terminate = ImsiAndSessionIDSet{
         ImsiAndSessionID(imsi, session_id)};
     schedule_termination(sessions_to_terminate);
     return;
@@ -1036,7 +1111,7 @@ void LocalEnforcer::handle_session_activate_subscriber_quota_state(
 }
 
 void LocalEnforcer::schedule_termination(
-    std::unordered_set<ImsiAndSessionID>& sessions) {
+    ImsiAndSessionIDSet& sessions) {
   evb_->runAfterDelay(
       [this, sessions] {
         SessionRead req;
@@ -1107,7 +1182,7 @@ void LocalEnforcer::complete_termination(
 
 void LocalEnforcer::terminate_multiple_sessions(
     SessionMap& session_map,
-    const std::unordered_set<ImsiAndSessionID>& sessions,
+    const ImsiAndSessionIDSet& sessions,
     SessionUpdate& session_update) {
   for (const auto& imsi_and_session_id : sessions) {
     const auto &imsi       = imsi_and_session_id.first,
@@ -1121,13 +1196,14 @@ void LocalEnforcer::terminate_multiple_sessions(
       return;
     }
     auto& session = **session_it;
-    start_session_termination(session, true, &session_update[imsi][session_id]);
+    start_session_termination(
+        *session, true, &session_update[imsi][session_id]);
   }
 }
 
 void LocalEnforcer::remove_rules_for_multiple_suspended_credit(
     SessionMap& session_map,
-    std::unordered_set<
+    folly::F14FastSet<
         ImsiSessionIDAndCreditkey, ImsiSessionIDAndCreditkey_hash>&
         suspended_credits,
     SessionUpdate& session_update) {
@@ -1144,31 +1220,31 @@ void LocalEnforcer::remove_rules_for_multiple_suspended_credit(
     }
     auto& session    = **session_it;
     auto& session_uc = session_update[imsi][session_id];
-    remove_rules_for_suspended_credit(session, ckey, &session_uc);
+    remove_rules_for_suspended_credit(*session, ckey, &session_uc);
   }
 }
 
 void LocalEnforcer::remove_rules_for_suspended_credit(
-    const std::unique_ptr<SessionState>& session, const CreditKey& ckey,
+    SessionState& session, const CreditKey& ckey,
     SessionStateUpdateCriteria* session_uc) {
   MLOG(MWARNING) << "Suspending RG " << ckey << " for "
-                 << session->get_session_id();
+                 << session.get_session_id();
   // suspend this specific credit
-  session->set_suspend_credit(ckey, true, session_uc);
+  session.set_suspend_credit(ckey, true, session_uc);
 
   // check if this is the last credit. That will trigger Final Unit Actions
-  session->suspend_service_if_needed_for_credit(ckey, session_uc);
+  session.suspend_service_if_needed_for_credit(ckey, session_uc);
 
   // Remove pipelined rules
   RulesToProcess rules_to_remove;
-  session->get_rules_per_credit_key(ckey, &rules_to_remove, session_uc);
+  session.get_rules_per_credit_key(ckey, &rules_to_remove, session_uc);
   propagate_rule_updates_to_pipelined(
-      session->get_config(), RulesToProcess{}, rules_to_remove, false);
+      session.get_config(), RulesToProcess{}, rules_to_remove, false);
 }
 
 void LocalEnforcer::add_rules_for_multiple_unsuspended_credit(
     SessionMap& session_map,
-    std::unordered_set<
+    folly::F14FastSet<
         ImsiSessionIDAndCreditkey, ImsiSessionIDAndCreditkey_hash>&
         unsuspended_credits,
     SessionUpdate& session_update) {
@@ -1185,23 +1261,23 @@ void LocalEnforcer::add_rules_for_multiple_unsuspended_credit(
     }
     auto& session    = **session_it;
     auto& session_uc = session_update[imsi][session_id];
-    add_rules_for_unsuspended_credit(session, ckey, &session_uc);
+    add_rules_for_unsuspended_credit(*session, ckey, &session_uc);
   }
 }
 
 void LocalEnforcer::add_rules_for_unsuspended_credit(
-    const std::unique_ptr<SessionState>& session, const CreditKey& ckey,
+    SessionState& session, const CreditKey& ckey,
     SessionStateUpdateCriteria* session_uc) {
   MLOG(MWARNING) << "Un-suspending RG " << ckey << " for "
-                 << session->get_session_id();
+                 << session.get_session_id();
   // unsuspend this credit
-  session->set_suspend_credit(ckey, false, session_uc);
+  session.set_suspend_credit(ckey, false, session_uc);
 
   //  add pipelined rules
   RulesToProcess rules_to_add;
-  session->get_rules_per_credit_key(ckey, &rules_to_add, session_uc);
+  session.get_rules_per_credit_key(ckey, &rules_to_add, session_uc);
   propagate_rule_updates_to_pipelined(
-      session->get_config(), rules_to_add, RulesToProcess{}, false);
+      session.get_config(), rules_to_add, RulesToProcess{}, false);
 }
 
 bool LocalEnforcer::handle_credit_update_failure(
@@ -1238,16 +1314,27 @@ bool LocalEnforcer::handle_credit_update_failure(
 void LocalEnforcer::update_charging_credits(
     SessionMap& session_map, const UpdateSessionResponse& response,
     UpdateChargingCreditActions& actions, SessionUpdate& session_update) {
+  // Responses for the same session tend to arrive back to back, so cache the
+  // last session_id -> session lookup
+  const std::string* last_session_id = nullptr;
+  optional<SessionVector::iterator> last_session_it;
   for (const auto& credit_update_resp : response.responses()) {
     const std::string& imsi       = credit_update_resp.sid();
     const std::string& session_id = credit_update_resp.session_id();
     const uint32_t& charging_key  = credit_update_resp.charging_key();
-    SessionSearchCriteria criteria(imsi, IMSI_AND_SESSION_ID, session_id);
-    auto session_it = session_store_.find_session(session_map, criteria);
-    if (!session_it) {
-      MLOG(MERROR) << "Could not find session " << session_id
-                   << " during charging update for RG " << charging_key;
-      continue;
+    optional<SessionVector::iterator> session_it;
+    if (last_session_it && *last_session_id == session_id) {
+      session_it = last_session_it;
+    } else {
+      SessionSearchCriteria criteria(imsi, IMSI_AND_SESSION_ID, session_id);
+      session_it = session_store_.find_session(session_map, criteria);
+      if (!session_it) {
+        MLOG(MERROR) << "Could not find session " << session_id
+                     << " during charging update for RG " << charging_key;
+        continue;
+      }
+      last_session_id = &session_id;
+      last_session_it = session_it;
     }
     auto& session = **session_it;
     auto& uc      = session_update[imsi][session_id];
@@ -1302,18 +1389,42 @@ void LocalEnforcer::update_monitoring_credits_and_rules(
   // included in all monitors or none.
   // To keep track of which timer is already tracked, we will have a set of
   // IMSIs that have pending re-validations
-  std::unordered_set<ImsiAndSessionID> sessions_with_revalidation;
+  ImsiAndSessionIDSet sessions_with_revalidation;
+  // Monitor responses are also grouped by session, so reuse the last
+  // session_id -> session lookup when possible
+  const std::string* last_session_id = nullptr;
+  optional<SessionVector::iterator> last_session_it;
+  // Coalesce the PipelineD updates of adjacent responses for the same
+  // session into a single deactivate/activate RPC pair
+  SessionState* batched_session = nullptr;
+  RulesToProcess batched_activation, batched_deactivation;
+  auto flush_pipelined_batch = [&]() {
+    if (batched_session != nullptr) {
+      propagate_rule_updates_to_pipelined(
+          batched_session->get_config(), batched_activation,
+          batched_deactivation, false);
+    }
+    batched_activation.clear();
+    batched_deactivation.clear();
+  };
   for (const auto& usage_monitor_resp : response.usage_monitor_responses()) {
     const std::string& imsi       = usage_monitor_resp.sid();
     const std::string& session_id = usage_monitor_resp.session_id();
     const std::string& mkey = usage_monitor_resp.credit().monitoring_key();
 
-    SessionSearchCriteria criteria(imsi, IMSI_AND_SESSION_ID, session_id);
-    auto session_it = session_store_.find_session(session_map, criteria);
-    if (!session_it) {
-      MLOG(MERROR) << "Could not find session for " << session_id
-                   << " during monitoring update for mkey " << mkey;
-      continue;
+    optional<SessionVector::iterator> session_it;
+    if (last_session_it && *last_session_id == session_id) {
+      session_it = last_session_it;
+    } else {
+      SessionSearchCriteria criteria(imsi, IMSI_AND_SESSION_ID, session_id);
+      session_it = session_store_.find_session(session_map, criteria);
+      if (!session_it) {
+        MLOG(MERROR) << "Could not find session for " << session_id
+                     << " during monitoring update for mkey " << mkey;
+        continue;
+      }
+      last_session_id = &session_id;
+      last_session_it = session_it;
     }
     auto& session               = **session_it;
     const SessionConfig& config = session->get_config();
@@ -1337,15 +1448,35 @@ void LocalEnforcer::update_monitoring_credits_and_rules(
         usage_monitor_resp.rules_to_remove(), &pending_deactivation, &uc);
 
     session->process_rules_to_install(
-        to_vec(usage_monitor_resp.static_rules_to_install()),
-        to_vec(usage_monitor_resp.dynamic_rules_to_install()),
-        &pending_activation, &pending_deactivation, &pending_bearer_setup,
-        &pending_scheduling, &uc);
+        usage_monitor_resp.static_rules_to_install(),
+        usage_monitor_resp.dynamic_rules_to_install(), &pending_activation,
+        &pending_deactivation, &pending_bearer_setup, &pending_scheduling,
+        &uc);
 
     handle_rule_scheduling(imsi, session_id, pending_scheduling);
 
-    propagate_rule_updates_to_pipelined(
-        config, pending_activation, pending_deactivation, false);
+    if (batched_session != session.get()) {
+      flush_pipelined_batch();
+      batched_session = session.get();
+    }
+    batched_activation.insert(
+        batched_activation.end(), pending_activation.begin(),
+        pending_activation.end());
+    // A rule activated by an earlier response in this batch and removed by
+    // this one must not be re-sent to PipelineD, since the flush issues the
+    // deactivations before the activations
+    for (const RuleToProcess& deactivate : pending_deactivation) {
+      batched_activation.erase(
+          std::remove_if(
+              batched_activation.begin(), batched_activation.end(),
+              [&deactivate](const RuleToProcess& activate) {
+                return activate.rule.id() == deactivate.rule.id();
+              }),
+          batched_activation.end());
+    }
+    batched_deactivation.insert(
+        batched_deactivation.end(), pending_deactivation.begin(),
+        pending_deactivation.end());
 
     if (terminate_on_wallet_exhaust() && is_wallet_exhausted(*session)) {
       actions.sessions_to_terminate.insert(ImsiAndSessionID(imsi, session_id));
@@ -1372,6 +1503,7 @@ void LocalEnforcer::update_monitoring_credits_and_rules(
       propagate_bearer_updates_to_mme(update);
     }
   }
+  flush_pipelined_batch();
 }
 
 void LocalEnforcer::update_session_credits_and_rules(
@@ -1409,7 +1541,8 @@ bool LocalEnforcer::handle_termination_from_access(
   }
   auto& session                 = **session_it;
   const std::string& session_id = session->get_session_id();
-  start_session_termination(session, false, &session_updates[imsi][session_id]);
+  start_session_termination(
+      *session, false, &session_updates[imsi][session_id]);
   return true;
 }
 
@@ -1422,7 +1555,8 @@ bool LocalEnforcer::find_and_terminate_session(
     return false;
   }
   auto& session = **session_it;
-  start_session_termination(session, true, &session_updates[imsi][session_id]);
+  start_session_termination(
+      *session, true, &session_updates[imsi][session_id]);
   return true;
 }
 
@@ -1437,7 +1571,7 @@ bool LocalEnforcer::handle_abort_session(
   auto& session    = **session_it;
   auto& session_uc = session_updates[imsi][session_id];
   // Propagate rule removals to PipelineD and notify Access
-  start_session_termination(session, true, &session_uc);
+  start_session_termination(*session, true, &session_uc);
   // ASRs do not require a CCR-T, this means we can immediately terminate
   // without waiting for final usage reports.
   events_reporter_->session_terminated(imsi, session);
@@ -1472,8 +1606,8 @@ void LocalEnforcer::handle_set_session_rules(
       const auto& config = session->get_config();
 
       const auto& apn = config.common_context.apn();
-      auto rule_set   = rule_set_by_sub.get_combined_rule_set_for_apn(apn);
-      if (!rule_set) {
+      RuleSetToApply rule_set;
+      if (!rule_set_by_sub.get_combined_rule_set_for_apn(apn, &rule_set)) {
         // No rule change needed for this APN
         continue;
       }
@@ -1483,7 +1617,7 @@ void LocalEnforcer::handle_set_session_rules(
       RulesToProcess pending_activation, pending_deactivation,
           pending_bearer_setup;
       session->apply_session_rule_set(
-          *rule_set, &pending_activation, &pending_deactivation,
+          rule_set, &pending_activation, &pending_deactivation,
           &pending_bearer_setup, &uc);
 
       // Propagate these rule changes to PipelineD and MME (if 4G)
@@ -1544,7 +1678,7 @@ void LocalEnforcer::init_policy_reauth(
   // won't stop changes from being applied for subsequent sessions.
   if (session_id == "") {
     for (const auto& session : it->second) {
-      init_policy_reauth_for_session(request, session, session_update);
+      init_policy_reauth_for_session(request, *session, session_update);
     }
     answer_out.set_result(ReAuthResult::UPDATE_INITIATED);
     return;
@@ -1559,46 +1693,59 @@ void LocalEnforcer::init_policy_reauth(
     return;
   }
   auto& session = **session_it;
-  init_policy_reauth_for_session(request, session, session_update);
+  init_policy_reauth_for_session(request, *session, session_update);
   answer_out.set_result(ReAuthResult::UPDATE_INITIATED);
 }
 
 void LocalEnforcer::init_policy_reauth_for_session(
     const PolicyReAuthRequest& request,
-    const std::unique_ptr<SessionState>& session,
+    SessionState& session,
     SessionUpdate& session_update) {
   std::string imsi = request.imsi();
   SessionStateUpdateCriteria& uc =
-      session_update[imsi][session->get_session_id()];
+      session_update[imsi][session.get_session_id()];
 
   receive_monitoring_credit_from_rar(request, session, &uc);
 
-  RulesToProcess pending_activation, pending_deactivation, pending_bearer_setup;
-  RulesToSchedule pending_scheduling;
+  // Reuse scratch vectors across RARs on this thread so a burst of reauths
+  // does not pay vector reallocation per request: clear() keeps the capacity
+  // grown by previous calls. Nothing below re-enters this handler, so the
+  // scratch space is never aliased.
+  static thread_local RulesToProcess pending_activation, pending_deactivation,
+      pending_bearer_setup;
+  static thread_local RulesToSchedule pending_scheduling;
+  pending_activation.clear();
+  pending_deactivation.clear();
+  pending_bearer_setup.clear();
+  pending_scheduling.clear();
+  pending_activation.reserve(
+      request.rules_to_install_size() +
+      request.dynamic_rules_to_install_size());
+  pending_deactivation.reserve(request.rules_to_remove_size());
 
   MLOG(MDEBUG) << "Processing policy reauth for subscriber " << request.imsi();
   if (revalidation_required(request.event_triggers())) {
-    schedule_revalidation(*session, request.revalidation_time(), &uc);
+    schedule_revalidation(session, request.revalidation_time(), &uc);
   }
 
-  session->process_rules_to_remove(
+  session.process_rules_to_remove(
       request.rules_to_remove(), &pending_deactivation, &uc);
 
-  session->process_rules_to_install(
-      to_vec(request.rules_to_install()),
-      to_vec(request.dynamic_rules_to_install()), &pending_activation,
-      &pending_deactivation, &pending_bearer_setup, &pending_scheduling, &uc);
+  session.process_rules_to_install(
+      request.rules_to_install(), request.dynamic_rules_to_install(),
+      &pending_activation, &pending_deactivation, &pending_bearer_setup,
+      &pending_scheduling, &uc);
 
-  handle_rule_scheduling(imsi, session->get_session_id(), pending_scheduling);
+  handle_rule_scheduling(imsi, session.get_session_id(), pending_scheduling);
 
   propagate_rule_updates_to_pipelined(
-      session->get_config(), pending_activation, pending_deactivation, false);
+      session.get_config(), pending_activation, pending_deactivation, false);
 
-  if (terminate_on_wallet_exhaust() && is_wallet_exhausted(*session)) {
+  if (terminate_on_wallet_exhaust() && is_wallet_exhausted(session)) {
     start_session_termination(session, true, &uc);
     return;
   }
-  if (session->get_config().common_context.rat_type() == TGPP_LTE) {
+  if (session.get_config().common_context.rat_type() == TGPP_LTE) {
     create_bearer(session, request, pending_bearer_setup);
   }
 }
@@ -1606,6 +1753,11 @@ void LocalEnforcer::init_policy_reauth_for_session(
 void LocalEnforcer::propagate_rule_updates_to_pipelined(
     const SessionConfig& config, const RulesToProcess& pending_activation,
     const RulesToProcess& pending_deactivation, bool always_send_activate) {
+  // OR the sizes so the common nothing-to-do case exits on a single compare
+  if (!always_send_activate &&
+      (pending_activation.size() | pending_deactivation.size()) == 0) {
+    return;
+  }
   const std::string& imsi = config.get_imsi();
   const auto ip_addr      = config.common_context.ue_ipv4();
   const auto ipv6_addr    = config.common_context.ue_ipv6();
@@ -1623,15 +1775,13 @@ void LocalEnforcer::propagate_rule_updates_to_pipelined(
     const auto msisdn = config.common_context.msisdn();
     pipelined_client_->activate_flows_for_rules(
         imsi, ip_addr, ipv6_addr, teids, msisdn, ambr, pending_activation,
-        std::bind(
-            &LocalEnforcer::handle_activate_ue_flows_callback, this, imsi,
-            ip_addr, ipv6_addr, teids, _1, _2));
+        ActivateFlowsCallback(this, imsi, ip_addr, ipv6_addr, teids));
   }
 }
 
 void LocalEnforcer::receive_monitoring_credit_from_rar(
     const PolicyReAuthRequest& request,
-    const std::unique_ptr<SessionState>& session,
+    SessionState& session,
     SessionStateUpdateCriteria* uc) {
   UsageMonitoringUpdateResponse monitoring_credit;
   monitoring_credit.set_session_id(request.session_id());
@@ -1642,34 +1792,16 @@ void LocalEnforcer::receive_monitoring_credit_from_rar(
   for (const auto& usage_monitoring_credit :
        request.usage_monitoring_credits()) {
     credit->CopyFrom(usage_monitoring_credit);
-    session->receive_monitor(monitoring_credit, uc);
-  }
-}
-
-std::vector<StaticRuleInstall> LocalEnforcer::to_vec(
-    const google::protobuf::RepeatedPtrField<magma::lte::StaticRuleInstall>
-        static_rule_installs) {
-  std::vector<StaticRuleInstall> out;
-  for (const auto& install : static_rule_installs) {
-    out.push_back(install);
+    session.receive_monitor(monitoring_credit, uc);
   }
-  return out;
-}
-
-std::vector<DynamicRuleInstall> LocalEnforcer::to_vec(
-    const google::protobuf::RepeatedPtrField<magma::lte::DynamicRuleInstall>
-        dynamic_rule_installs) {
-  std::vector<DynamicRuleInstall> out;
-  for (const auto& install : dynamic_rule_installs) {
-    out.push_back(install);
-  }
-  return out;
 }
 
 void LocalEnforcer::process_rules_to_install(
     SessionState& session,
-    const std::vector<StaticRuleInstall>& static_rule_installs,
-    const std::vector<DynamicRuleInstall>& dynamic_rule_installs,
+    const google::protobuf::RepeatedPtrField<StaticRuleInstall>&
+        static_rule_installs,
+    const google::protobuf::RepeatedPtrField<DynamicRuleInstall>&
+        dynamic_rule_installs,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
     SessionStateUpdateCriteria* session_uc) {
@@ -1703,9 +1835,12 @@ void LocalEnforcer::handle_rule_scheduling(
 
 bool LocalEnforcer::revalidation_required(
     const google::protobuf::RepeatedField<int>& event_triggers) {
-  auto it = std::find(
-      event_triggers.begin(), event_triggers.end(), REVALIDATION_TIMEOUT);
-  return it != event_triggers.end();
+  for (const int trigger : event_triggers) {
+    if (trigger == REVALIDATION_TIMEOUT) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void LocalEnforcer::schedule_revalidation(
@@ -1720,7 +1855,8 @@ void LocalEnforcer::schedule_revalidation(
   auto delta = magma::time_difference_from_now(revalidation_time);
   MLOG(MINFO) << "Scheduling revalidation in " << delta.count() << "ms for "
               << session_id;
-  evb_->runAfterDelay(
+  timer_wheel_.insert(
+      delta,
       [=] {
         MLOG(MINFO) << "Revalidation timeout! for " << session_id;
         auto session_map = session_store_.read_sessions(req);
@@ -1736,10 +1872,29 @@ void LocalEnforcer::schedule_revalidation(
         auto& uc = update[imsi][session_id];
         session->mark_event_trigger_as_triggered(REVALIDATION_TIMEOUT, &uc);
         session_store_.update_sessions(update);
-      },
-      delta.count());
+      });
 }  // namespace magma
 
+LocalEnforcer::ActivateFlowsCallback::ActivateFlowsCallback(
+    LocalEnforcer* enforcer, const std::string& imsi,
+    const std::string& ip_addr, const std::string& ipv6_addr,
+    const Teids& teids)
+    : enforcer(enforcer),
+      imsi(imsi),
+      ip_addr(ip_addr),
+      ipv6_addr(ipv6_addr),
+      agw_teid(teids.agw_teid()),
+      enb_teid(teids.enb_teid()) {}
+
+void LocalEnforcer::ActivateFlowsCallback::operator()(
+    Status status, ActivateFlowsResult resp) const {
+  Teids teids;
+  teids.set_agw_teid(agw_teid);
+  teids.set_enb_teid(enb_teid);
+  enforcer->handle_activate_ue_flows_callback(
+      imsi, ip_addr, ipv6_addr, teids, status, std::move(resp));
+}
+
 void LocalEnforcer::handle_activate_ue_flows_callback(
     const std::string& imsi, const std::string& ip_addr,
     const std::string& ipv6_addr, const Teids teids, Status status,
@@ -1812,10 +1967,10 @@ void LocalEnforcer::handle_add_ue_mac_flow_callback(
 }
 
 void LocalEnforcer::create_bearer(
-    const std::unique_ptr<SessionState>& session,
+    SessionState& session,
     const PolicyReAuthRequest& request,
     const std::vector<RuleToProcess>& dynamic_rules) {
-  const auto& config = session->get_config();
+  const auto& config = session.get_config();
   if (!config.rat_specific_context.has_lte_context()) {
     MLOG(MWARNING) << "No LTE Session Context is specified for session";
     return;
@@ -1837,7 +1992,7 @@ void LocalEnforcer::create_bearer(
     auto req_policy_rules = req.mutable_policy_rules();
     for (const auto& to_process : dynamic_rules) {
       optional<PolicyType> p_type =
-          session->get_policy_type(to_process.rule.id());
+          session.get_policy_type(to_process.rule.id());
       if (p_type && *p_type == DYNAMIC) {
         req_policy_rules->Add()->CopyFrom(to_process.rule);
       }
@@ -2018,7 +2173,7 @@ std::unique_ptr<Timezone> LocalEnforcer::compute_access_timezone() {
 static void handle_command_level_result_code_for_monitors(
     const std::string& imsi, const std::string& session_id,
     const uint32_t result_code,
-    std::unordered_set<ImsiAndSessionID>& sessions_to_terminate) {
+    ImsiAndSessionIDSet& sessions_to_terminate) {
   if (DiameterCodeHandler::is_permanent_failure(result_code)) {
     MLOG(MERROR) << session_id << " Received permanent failure result code "
                  << result_code << " during update" << session_id;
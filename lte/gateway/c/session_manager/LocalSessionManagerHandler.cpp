@@ -243,7 +243,8 @@ void LocalSessionManagerHandlerImpl::CreateSession(
   auto& request_cpy = *request;
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
   enforcer_->get_event_base().runInEventBaseThread(
-      [this, context, response_callback, request_cpy]() {
+      [this, context, response_callback = std::move(response_callback),
+       request_cpy]() {
         SessionConfig cfg(request_cpy);
         const std::string& imsi = cfg.get_imsi();
         const auto& session_id  = id_gen_.gen_session_id(imsi);
@@ -485,7 +486,7 @@ void LocalSessionManagerHandlerImpl::EndSession(
   auto& apn         = request->apn();
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
   enforcer_->get_event_base().runInEventBaseThread(
-      [this, sid, apn, response_callback]() {
+      [this, sid, apn, response_callback = std::move(response_callback)]() {
         auto session_map = session_store_.read_sessions({sid.id()});
         end_session(session_map, sid, apn, response_callback);
       });
@@ -604,8 +605,9 @@ void LocalSessionManagerHandlerImpl::UpdateTunnelIds(
                << " with default bearer id: " << request->bearer_id()
                << " enb_teid= " << request->enb_teid()
                << " agw_teid= " << request->agw_teid();
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy, imsi,
-                                                    response_callback]() {
+  enforcer_->get_event_base().runInEventBaseThread(
+      [this, request_cpy, imsi,
+       response_callback = std::move(response_callback)]() {
     auto session_map = session_store_.read_sessions({imsi});
     auto success     = enforcer_->update_tunnel_ids(session_map, request_cpy);
     if (!success) {
@@ -59,9 +59,10 @@ SessionMap MemoryStoreClient::read_all_sessions() {
 bool MemoryStoreClient::write_sessions(SessionMap session_map) {
   for (auto& it : session_map) {
     auto sessions = std::vector<StoredSessionState>{};
-    for (auto const& session : it.second) {
-      auto stored_session = session->marshal();
-      sessions.push_back(stored_session);
+    for (auto& session : it.second) {
+      // write_sessions takes the SessionMap by value, so the in-memory
+      // SessionStates die here and can be moved from
+      sessions.push_back(std::move(*session).marshal_move());
     }
     if (sessions.empty()) {
       // if session is empty that means subs should be deleted from the map
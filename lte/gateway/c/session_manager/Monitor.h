@@ -47,7 +47,9 @@ struct Monitor {
   // Monitor will be deleted when the credit is exhausted and no more grants are
   // received or when we receive the explicit action
   bool should_delete_monitor() {
-    return credit.current_grant_contains_zero() && credit.is_quota_exhausted(1);
+    constexpr uint8_t deletable = SessionCredit::REPORTING_GRANT_CONTAINS_ZERO |
+                                  SessionCredit::REPORTING_QUOTA_EXHAUSTED;
+    return (credit.reporting_status(1) & deletable) == deletable;
   }
 
   bool should_send_update() {
@@ -55,13 +57,10 @@ struct Monitor {
     if (credit.is_report_last_credit()) {
       return true;
     }
-    // updated trigger due to usage threshold (80%)
-    if (!credit.current_grant_contains_zero() &&
-        credit.is_quota_exhausted(SessionCredit::USAGE_REPORTING_THRESHOLD)) {
-      // if grant contains zeros that means we are in final. Do no report
-      return true;
-    }
-    return false;
+    // updated trigger due to usage threshold (80%). If the grant contains
+    // zeros that means we are in final. Do no report
+    return credit.reporting_status(SessionCredit::USAGE_REPORTING_THRESHOLD) ==
+           SessionCredit::REPORTING_QUOTA_EXHAUSTED;
   }
 };
 
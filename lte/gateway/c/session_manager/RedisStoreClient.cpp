@@ -193,7 +193,9 @@ std::string RedisStoreClient::serialize_session_vec(
     SessionVector& session_vec) {
   folly::dynamic marshaled = folly::dynamic::array;
   for (auto& session_ptr : session_vec) {
-    auto stored_session = session_ptr->marshal();
+    // Only reached from write_sessions, which owns the SessionMap by value,
+    // so the sessions can be moved from
+    auto stored_session = std::move(*session_ptr).marshal_move();
     marshaled.push_back(serialize_stored_session(stored_session));
   }
   std::string serialized = folly::toJson(marshaled);
@@ -209,7 +211,7 @@ SessionVector RedisStoreClient::deserialize_session_vec(
     for (auto& it : marshaled) {
       auto stored_session = deserialize_stored_session(it.getString());
       session_vec.push_back(
-          SessionState::unmarshal(stored_session, *rule_store_));
+          SessionState::unmarshal(std::move(stored_session), *rule_store_));
     }
   } catch (std::exception const& e) {
     // Very rare but we've seen a crash here
@@ -141,11 +141,21 @@ bool PolicyRuleBiMap::get_rule(
   return true;
 }
 
+std::shared_ptr<const PolicyRule> PolicyRuleBiMap::get_rule_ptr(
+    const std::string& rule_id) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  auto it = rules_by_rule_id_.find(rule_id);
+  if (it == rules_by_rule_id_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
 bool PolicyRuleBiMap::get_rules_by_ids(
     const std::vector<std::string>& rule_ids,
     std::vector<PolicyRule>& rules_out) {
   std::lock_guard<std::mutex> lock(map_mutex_);
-  for (const std::string rule_id : rule_ids) {
+  for (const std::string& rule_id : rule_ids) {
     auto it = rules_by_rule_id_.find(rule_id);
     if (it == rules_by_rule_id_.end()) {
       return false;
@@ -209,6 +219,27 @@ bool PolicyRuleBiMap::get_monitoring_key_for_rule_id(
   return true;
 }
 
+bool PolicyRuleBiMap::get_rule_keys_for_rule_id(
+    const std::string& rule_id, CreditKey* charging_key,
+    bool* has_charging_key, std::string* monitoring_key,
+    bool* has_monitoring_key) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  auto it = rules_by_rule_id_.find(rule_id);
+  if (it == rules_by_rule_id_.end()) {
+    return false;
+  }
+  const auto tracking_type = it->second->tracking_type();
+  if (!*has_charging_key && should_track_charging_key(tracking_type)) {
+    charging_key->set(it->second.get());
+    *has_charging_key = true;
+  }
+  if (!*has_monitoring_key && should_track_monitoring_key(tracking_type)) {
+    monitoring_key->assign(it->second->monitoring_key());
+    *has_monitoring_key = true;
+  }
+  return true;
+}
+
 bool PolicyRuleBiMap::get_rule_ids_for_charging_key(
     const CreditKey& charging_key, std::vector<std::string>& rules_out) {
   std::lock_guard<std::mutex> lock(map_mutex_);
@@ -230,9 +261,26 @@ uint32_t PolicyRuleBiMap::monitored_rules_count() {
   return rules_by_monitoring_key_.policy_count();
 }
 
+uint32_t PolicyRuleBiMap::monitored_rules_count_for_ids(
+    const std::vector<std::string>& rule_ids) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  uint32_t count = 0;
+  for (const std::string& rule_id : rule_ids) {
+    auto it = rules_by_rule_id_.find(rule_id);
+    if (it != rules_by_rule_id_.end() &&
+        should_track_monitoring_key(it->second->tracking_type())) {
+      count++;
+    }
+  }
+  return count;
+}
+
 bool PolicyRuleBiMap::get_rule_ids(std::vector<std::string>& rules_ids_out) {
   std::lock_guard<std::mutex> lock(map_mutex_);
-  for (auto kv : rules_by_rule_id_) {
+  // iterate by reference and reserve up front; the by-value loop copied the
+  // rule ID and bumped the rule shared_ptr once per entry just to read a key
+  rules_ids_out.reserve(rules_ids_out.size() + rules_by_rule_id_.size());
+  for (const auto& kv : rules_by_rule_id_) {
     rules_ids_out.push_back(kv.first);
   }
   return true;
@@ -240,12 +288,23 @@ bool PolicyRuleBiMap::get_rule_ids(std::vector<std::string>& rules_ids_out) {
 
 bool PolicyRuleBiMap::get_rules(std::vector<PolicyRule>& rules_out) {
   std::lock_guard<std::mutex> lock(map_mutex_);
-  for (auto kv : rules_by_rule_id_) {
+  rules_out.reserve(rules_out.size() + rules_by_rule_id_.size());
+  for (const auto& kv : rules_by_rule_id_) {
     rules_out.push_back(*kv.second);
   }
   return true;
 }
 
+bool PolicyRuleBiMap::get_rule_ptrs(
+    std::vector<std::shared_ptr<const PolicyRule>>& rules_out) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  rules_out.reserve(rules_out.size() + rules_by_rule_id_.size());
+  for (const auto& kv : rules_by_rule_id_) {
+    rules_out.push_back(kv.second);
+  }
+  return true;
+}
+
 void ConvergedRuleStore::insert_rule(uint32_t id, const SetGroupPDR& rule) {
   auto rule_p = std::make_shared<SetGroupPDR>(rule);
   std::lock_guard<std::mutex> lock(map_mutex_);
@@ -78,6 +78,12 @@ class PolicyRuleBiMap {
   // If the output rule param is NULL, the rule object is not copied.
   virtual bool get_rule(const std::string& rule_id, PolicyRule* rule_out);
 
+  // Get a shared reference to the stored rule definition without copying the
+  // proto. Returns nullptr if the rule is not found. The returned rule is
+  // immutable: sync_rules replaces stored entries instead of mutating them.
+  virtual std::shared_ptr<const PolicyRule> get_rule_ptr(
+      const std::string& rule_id);
+
   virtual bool get_rules_by_ids(
       const std::vector<std::string>& rule_ids,
       std::vector<PolicyRule>& rules_out);
@@ -98,6 +104,18 @@ class PolicyRuleBiMap {
   virtual bool get_monitoring_key_for_rule_id(
       const std::string& rule_id, std::string* monitoring_key);
 
+  /**
+   * Combined lookup used on the usage reporting path: finds the rule once
+   * and fills in whichever of the charging/monitoring keys its tracking type
+   * tracks. Keys whose has_* flag is already true are left untouched, so the
+   * call can be chained across bimaps.
+   * @returns false if the rule doesn't exist, true if so
+   */
+  virtual bool get_rule_keys_for_rule_id(
+      const std::string& rule_id, CreditKey* charging_key,
+      bool* has_charging_key, std::string* monitoring_key,
+      bool* has_monitoring_key);
+
   /**
    * Get all the rules for a given key. Rule ids are copied into rules_out
    */
@@ -115,10 +133,23 @@ class PolicyRuleBiMap {
    */
   virtual uint32_t monitored_rules_count();
 
+  /**
+   * Get how many of the given rule IDs are tracked by a monitoring key.
+   * Locks the store once for the whole batch instead of once per rule.
+   */
+  virtual uint32_t monitored_rules_count_for_ids(
+      const std::vector<std::string>& rule_ids);
+
   virtual bool get_rule_ids(std::vector<std::string>& rules_ids_out);
 
   virtual bool get_rules(std::vector<PolicyRule>& rules_out);
 
+  // Like get_rules, but hands out shared references to the stored rules
+  // instead of copying each proto. The returned rules are immutable:
+  // sync_rules replaces stored entries instead of mutating them.
+  virtual bool get_rule_ptrs(
+      std::vector<std::shared_ptr<const PolicyRule>>& rules_out);
+
  protected:
   // guards all three maps below
   std::mutex map_mutex_;
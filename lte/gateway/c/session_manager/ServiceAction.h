@@ -73,8 +73,8 @@ class ServiceAction {
     return *this;
   }
 
-  ServiceAction& set_ambr(const optional<AggregatedMaximumBitrate> ambr) {
-    ambr_ = ambr;
+  ServiceAction& set_ambr(optional<AggregatedMaximumBitrate> ambr) {
+    ambr_ = std::move(ambr);
     return *this;
   }
 
@@ -107,15 +107,21 @@ class ServiceAction {
 
   const CreditKey& get_credit_key() const { return credit_key_; }
 
-  const optional<AggregatedMaximumBitrate> get_ambr() const { return ambr_; }
+  // Returned by reference: optional<Message> copies the whole proto otherwise
+  const optional<AggregatedMaximumBitrate>& get_ambr() const { return ambr_; }
 
   const std::string& get_msisdn() const { return *msisdn_; }
 
   // RulesToProcess
-  RulesToProcess get_gx_rules_to_install() const { return gx_to_install_; }
+  // Returned by reference: each entry carries a full PolicyRule proto
+  const RulesToProcess& get_gx_rules_to_install() const {
+    return gx_to_install_;
+  }
   RulesToProcess* get_mutable_gx_rules_to_install() { return &gx_to_install_; }
 
-  RulesToProcess get_gy_rules_to_install() const { return gy_to_install_; }
+  const RulesToProcess& get_gy_rules_to_install() const {
+    return gy_to_install_;
+  }
   RulesToProcess* get_mutable_gy_rules_to_install() { return &gy_to_install_; }
 
  private:
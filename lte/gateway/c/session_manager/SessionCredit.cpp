@@ -61,7 +61,7 @@ SessionCredit::SessionCredit(const StoredSessionCredit& marshaled) {
   }
 }
 
-StoredSessionCredit SessionCredit::marshal() const {
+StoredSessionCredit SessionCredit::marshal() const& {
   StoredSessionCredit marshaled{};
   marshaled.reporting              = reporting_;
   marshaled.credit_limit_type      = credit_limit_type_;
@@ -79,6 +79,24 @@ StoredSessionCredit SessionCredit::marshal() const {
   return marshaled;
 }
 
+StoredSessionCredit SessionCredit::marshal() && {
+  StoredSessionCredit marshaled{};
+  marshaled.reporting              = reporting_;
+  marshaled.credit_limit_type      = credit_limit_type_;
+  marshaled.grant_tracking_type    = grant_tracking_type_;
+  marshaled.received_granted_units = std::move(received_granted_units_);
+  marshaled.report_last_credit     = report_last_credit_;
+  marshaled.time_of_first_usage    = time_of_first_usage_;
+  marshaled.time_of_last_usage     = time_of_last_usage_;
+
+  for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
+       bucket_int++) {
+    Bucket bucket             = static_cast<Bucket>(bucket_int);
+    marshaled.buckets[bucket] = buckets_[bucket];
+  }
+  return marshaled;
+}
+
 SessionCreditUpdateCriteria SessionCredit::get_update_criteria() const {
   SessionCreditUpdateCriteria credit_uc{};
   credit_uc.deleted                = false;
@@ -88,11 +106,7 @@ SessionCreditUpdateCriteria SessionCredit::get_update_criteria() const {
   credit_uc.time_of_first_usage    = time_of_first_usage_;
   credit_uc.time_of_last_usage     = time_of_last_usage_;
 
-  for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
-       bucket_int++) {
-    Bucket bucket                   = static_cast<Bucket>(bucket_int);
-    credit_uc.bucket_deltas[bucket] = 0;
-  }
+  // bucket_deltas is already zero-initialized
   return credit_uc;
 }
 
@@ -267,6 +281,91 @@ uint64_t SessionCredit::calculate_delta_allowed(
   }
 }
 
+uint8_t SessionCredit::reporting_status(float threshold) const {
+  const bool finite = (credit_limit_type_ == FINITE);
+  auto rx_exhausted = [&] {
+    return finite && compute_quota_exhausted(
+                         buckets_[ALLOWED_RX], buckets_[USED_RX], threshold,
+                         buckets_[ALLOWED_FLOOR_RX]);
+  };
+  auto tx_exhausted = [&] {
+    return finite && compute_quota_exhausted(
+                         buckets_[ALLOWED_TX], buckets_[USED_TX], threshold,
+                         buckets_[ALLOWED_FLOOR_TX]);
+  };
+  auto total_exhausted = [&] {
+    return finite && compute_quota_exhausted(
+                         buckets_[ALLOWED_TOTAL],
+                         buckets_[USED_TX] + buckets_[USED_RX], threshold,
+                         buckets_[ALLOWED_FLOOR_TOTAL]);
+  };
+  uint8_t status = 0;
+  switch (grant_tracking_type_) {
+    case TRACKING_UNSET:
+      // in case we haven't even initialized the credit at all but we have
+      // received traffic, then the session should be marked as exhausted. We
+      // also cannot tell whether the grant contains zeroes
+      status = REPORTING_GRANT_CONTAINS_ZERO;
+      if (finite) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    case ALL_TOTAL_TX_RX:
+      // Monitors should not have this mode enabled
+      MLOG(MWARNING) << "Possible monitor with ALL_TOTAL_TX_RX enabled";
+      if (is_received_grented_unit_zero(received_granted_units_.total()) ||
+          is_received_grented_unit_zero(received_granted_units_.tx()) ||
+          is_received_grented_unit_zero(received_granted_units_.rx())) {
+        status |= REPORTING_GRANT_CONTAINS_ZERO;
+      }
+      if (rx_exhausted() || tx_exhausted() || total_exhausted()) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    case RX_ONLY:
+      if (is_received_grented_unit_zero(received_granted_units_.rx())) {
+        status |= REPORTING_GRANT_CONTAINS_ZERO;
+      }
+      if (rx_exhausted()) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    case TX_ONLY:
+      if (is_received_grented_unit_zero(received_granted_units_.tx())) {
+        status |= REPORTING_GRANT_CONTAINS_ZERO;
+      }
+      if (tx_exhausted()) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    case TX_AND_RX:
+      if (is_received_grented_unit_zero(received_granted_units_.tx()) ||
+          is_received_grented_unit_zero(received_granted_units_.rx())) {
+        status |= REPORTING_GRANT_CONTAINS_ZERO;
+      }
+      if (rx_exhausted() || tx_exhausted()) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    case TOTAL_ONLY:
+      if (is_received_grented_unit_zero(received_granted_units_.total())) {
+        status |= REPORTING_GRANT_CONTAINS_ZERO;
+      }
+      if (total_exhausted()) {
+        status |= REPORTING_QUOTA_EXHAUSTED;
+      }
+      break;
+    default:
+      MLOG(MERROR) << "Invalid grant_tracking_type="
+                   << grant_type_to_str(grant_tracking_type_);
+      // matches the separate checks: unknown types count as zero-containing
+      // but not exhausted
+      status = REPORTING_GRANT_CONTAINS_ZERO;
+      break;
+  }
+  return status;
+}
+
 bool SessionCredit::is_quota_exhausted(float threshold) const {
   if (credit_limit_type_ != FINITE) {
     return false;
@@ -495,9 +594,7 @@ void SessionCredit::apply_update_criteria(
 
   // add credit
   for (int i = USED_TX; i != BUCKET_ENUM_MAX_VALUE; i++) {
-    Bucket bucket = static_cast<Bucket>(i);
-    auto credit   = credit_uc.bucket_deltas.find(bucket)->second;
-    buckets_[bucket] += credit;
+    buckets_[i] += credit_uc.bucket_deltas[i];
   }
 }
 
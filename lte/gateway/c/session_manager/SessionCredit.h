@@ -40,7 +40,11 @@ class SessionCredit {
 
   explicit SessionCredit(const StoredSessionCredit& marshaled);
 
-  StoredSessionCredit marshal() const;
+  StoredSessionCredit marshal() const&;
+
+  // Rvalue overload used by SessionState::marshal_move: moves the granted
+  // units proto out instead of copying it
+  StoredSessionCredit marshal() &&;
 
   /**
    * get_update_criteria constructs a SessionCreditUpdateCriteria with default
@@ -145,6 +149,21 @@ class SessionCredit {
 
   bool current_grant_contains_zero() const;
 
+  // Bits returned by reporting_status
+  enum ReportingStatus : uint8_t {
+    REPORTING_GRANT_CONTAINS_ZERO = 1 << 0,
+    REPORTING_QUOTA_EXHAUSTED     = 1 << 1,
+  };
+
+  /**
+   * reporting_status evaluates current_grant_contains_zero and
+   * is_quota_exhausted together, branching on grant_tracking_type_ once and
+   * only reading the buckets the grant actually tracks. Monitor's per-report
+   * checks run this for every monitor on every reporting tick, so the two
+   * facts are computed in a single pass.
+   */
+  uint8_t reporting_status(float usage_reporting_threshold) const;
+
   /**
    * A threshold represented as a ratio for triggering usage update before
    * an user completely used up the quota
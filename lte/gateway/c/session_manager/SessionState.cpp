@@ -42,7 +42,9 @@ const char* DIRECTION_UP            = "up";
 const char* DIRECTION_DOWN          = "down";
 // TODO(@themarwhal): SessionD should own the naming of the drop all rule so
 // that we never regress here
-const char* DROP_ALL_RULE = "internal_default_drop_flow_rule";
+// std::string so comparisons against reported rule ids can early-out on
+// length instead of walking the characters
+const std::string DROP_ALL_RULE = "internal_default_drop_flow_rule";
 }  // namespace
 
 using magma::service303::increment_counter;
@@ -58,8 +60,8 @@ void remove_from_vec_by_value(std::vector<T>& vec, T value) {
 }
 
 std::unique_ptr<SessionState> SessionState::unmarshal(
-    const StoredSessionState& marshaled, StaticRuleStore& rule_store) {
-  return std::make_unique<SessionState>(marshaled, rule_store);
+    StoredSessionState marshaled, StaticRuleStore& rule_store) {
+  return std::make_unique<SessionState>(std::move(marshaled), rule_store);
 }
 
 StoredSessionState SessionState::marshal() {
@@ -76,66 +78,108 @@ StoredSessionState SessionState::marshal() {
   marshaled.request_number          = request_number_;
   marshaled.pdp_start_time          = pdp_start_time_;
   marshaled.pdp_end_time            = pdp_end_time_;
-  marshaled.pending_event_triggers  = pending_event_triggers_;
+  marshaled.pending_event_triggers  = get_event_triggers();
   marshaled.revalidation_time       = revalidation_time_;
   marshaled.bearer_id_by_policy     = bearer_id_by_policy_;
   marshaled.create_session_response = create_session_response_;
 
   marshaled.monitor_map = StoredMonitorMap();
+  marshaled.monitor_map.reserve(monitor_map_.size());
   for (auto& monitor_pair : monitor_map_) {
     StoredMonitor monitor{};
-    monitor.credit = monitor_pair.second->credit.marshal();
-    monitor.level  = monitor_pair.second->level;
+    monitor.credit = monitor_pair.second.credit.marshal();
+    monitor.level  = monitor_pair.second.level;
     marshaled.monitor_map[monitor_pair.first] = monitor;
   }
   marshaled.session_level_key = session_level_key_;
 
   marshaled.credit_map = StoredChargingCreditMap(4, &ccHash, &ccEqual);
+  marshaled.credit_map.reserve(credit_map_.size());
   for (auto& credit_pair : credit_map_) {
     auto key                  = CreditKey();
     key.rating_group          = credit_pair.first.rating_group;
     key.service_identifier    = credit_pair.first.service_identifier;
-    marshaled.credit_map[key] = credit_pair.second->marshal();
+    marshaled.credit_map[key] = credit_pair.second.marshal();
   }
 
-  for (auto& rule_id : active_static_rules_) {
-    marshaled.static_rule_ids.push_back(rule_id);
-  }
-  for (auto& rule : pdr_list_) {
-    marshaled.pdr_list.push_back(rule);
-  }
+  marshaled.static_rule_ids = active_static_rules_;
+  marshaled.pdr_list        = pdr_list_;
 
-  std::vector<PolicyRule> dynamic_rules;
-  dynamic_rules_.get_rules(dynamic_rules);
-  marshaled.dynamic_rules = std::move(dynamic_rules);
+  dynamic_rules_.get_rules(marshaled.dynamic_rules);
+  gy_dynamic_rules_.get_rules(marshaled.gy_dynamic_rules);
 
-  std::vector<PolicyRule> gy_dynamic_rules;
-  gy_dynamic_rules_.get_rules(gy_dynamic_rules);
-  marshaled.gy_dynamic_rules = std::move(gy_dynamic_rules);
+  marshaled.scheduled_static_rules = scheduled_static_rules_;
+  scheduled_dynamic_rules_.get_rules(marshaled.scheduled_dynamic_rules);
+
+  marshaled.rule_lifetimes = rule_lifetimes_;
+
+  marshaled.policy_version_and_stats = policy_version_and_stats_;
+
+  return marshaled;
+}
+
+StoredSessionState SessionState::marshal_move() && {
+  StoredSessionState marshaled{};
+
+  marshaled.fsm_state = curr_state_;
+  // capture the IMSI before config_ is moved out from under get_imsi()
+  marshaled.imsi       = get_imsi();
+  marshaled.config     = std::move(config_);
+  marshaled.session_id = std::move(session_id_);
+  // 5G session version handling
+  marshaled.current_version         = current_version_;
+  marshaled.subscriber_quota_state  = subscriber_quota_state_;
+  marshaled.tgpp_context            = std::move(tgpp_context_);
+  marshaled.request_number          = request_number_;
+  marshaled.pdp_start_time          = pdp_start_time_;
+  marshaled.pdp_end_time            = pdp_end_time_;
+  marshaled.pending_event_triggers  = get_event_triggers();
+  marshaled.revalidation_time       = revalidation_time_;
+  marshaled.bearer_id_by_policy     = std::move(bearer_id_by_policy_);
+  marshaled.create_session_response = std::move(create_session_response_);
 
-  for (auto& rule_id : scheduled_static_rules_) {
-    marshaled.scheduled_static_rules.insert(rule_id);
+  marshaled.monitor_map = StoredMonitorMap();
+  marshaled.monitor_map.reserve(monitor_map_.size());
+  for (auto& monitor_pair : monitor_map_) {
+    StoredMonitor monitor{};
+    monitor.credit = std::move(monitor_pair.second.credit).marshal();
+    monitor.level  = monitor_pair.second.level;
+    marshaled.monitor_map[monitor_pair.first] = std::move(monitor);
   }
-  std::vector<PolicyRule> scheduled_dynamic_rules;
-  scheduled_dynamic_rules_.get_rules(scheduled_dynamic_rules);
-  marshaled.scheduled_dynamic_rules = std::move(scheduled_dynamic_rules);
+  marshaled.session_level_key = std::move(session_level_key_);
 
-  for (auto& it : rule_lifetimes_) {
-    marshaled.rule_lifetimes[it.first] = it.second;
+  marshaled.credit_map = StoredChargingCreditMap(4, &ccHash, &ccEqual);
+  marshaled.credit_map.reserve(credit_map_.size());
+  for (auto& credit_pair : credit_map_) {
+    auto key                  = CreditKey();
+    key.rating_group          = credit_pair.first.rating_group;
+    key.service_identifier    = credit_pair.first.service_identifier;
+    marshaled.credit_map[key] = std::move(credit_pair.second).marshal();
   }
 
-  marshaled.policy_version_and_stats = policy_version_and_stats_;
+  marshaled.static_rule_ids = std::move(active_static_rules_);
+  marshaled.pdr_list        = std::move(pdr_list_);
+
+  dynamic_rules_.get_rules(marshaled.dynamic_rules);
+  gy_dynamic_rules_.get_rules(marshaled.gy_dynamic_rules);
+
+  marshaled.scheduled_static_rules = std::move(scheduled_static_rules_);
+  scheduled_dynamic_rules_.get_rules(marshaled.scheduled_dynamic_rules);
+
+  marshaled.rule_lifetimes = std::move(rule_lifetimes_);
+
+  marshaled.policy_version_and_stats = std::move(policy_version_and_stats_);
 
   return marshaled;
 }
 
 SessionState::SessionState(
-    const StoredSessionState& marshaled, StaticRuleStore& rule_store)
-    : imsi_(marshaled.imsi),
-      session_id_(marshaled.session_id),
+    StoredSessionState marshaled, StaticRuleStore& rule_store)
+    : imsi_(std::move(marshaled.imsi)),
+      session_id_(std::move(marshaled.session_id)),
       request_number_(marshaled.request_number),
       curr_state_(marshaled.fsm_state),
-      config_(marshaled.config),
+      config_(std::move(marshaled.config)),
       pdp_start_time_(marshaled.pdp_start_time),
       pdp_end_time_(marshaled.pdp_end_time),
       // 5G session version handlimg
@@ -143,49 +187,53 @@ SessionState::SessionState(
       // SMF-UPF version mismatch, retransmission counter
       rtx_counter_(0),
       subscriber_quota_state_(marshaled.subscriber_quota_state),
-      tgpp_context_(marshaled.tgpp_context),
-      create_session_response_(marshaled.create_session_response),
-      policy_version_and_stats_(marshaled.policy_version_and_stats),
+      tgpp_context_(std::move(marshaled.tgpp_context)),
+      create_session_response_(std::move(marshaled.create_session_response)),
+      policy_version_and_stats_(std::move(marshaled.policy_version_and_stats)),
       static_rules_(rule_store),
-      pending_event_triggers_(marshaled.pending_event_triggers),
       revalidation_time_(marshaled.revalidation_time),
       credit_map_(4, &ccHash, &ccEqual),
-      bearer_id_by_policy_(marshaled.bearer_id_by_policy) {
-  session_level_key_ = marshaled.session_level_key;
-  for (auto it : marshaled.monitor_map) {
+      bearer_id_by_policy_(std::move(marshaled.bearer_id_by_policy)) {
+  for (const auto& it : marshaled.pending_event_triggers) {
+    // guard against out-of-range values from older serialized state
+    if (it.first >= 0 && it.first < EventTrigger_ARRAYSIZE) {
+      pending_event_triggers_present_.set(it.first);
+      pending_event_triggers_state_[it.first] = it.second;
+    }
+  }
+  session_level_key_ = std::move(marshaled.session_level_key);
+  monitor_map_.reserve(marshaled.monitor_map.size());
+  for (const auto& it : marshaled.monitor_map) {
     Monitor monitor;
     monitor.credit = SessionCredit(it.second.credit);
     monitor.level  = it.second.level;
 
-    monitor_map_[it.first] = std::make_unique<Monitor>(monitor);
+    monitor_map_[it.first] = std::move(monitor);
   }
 
+  credit_map_.reserve(marshaled.credit_map.size());
   for (const auto& it : marshaled.credit_map) {
-    credit_map_[it.first] =
-        std::make_unique<ChargingGrant>(ChargingGrant(it.second));
+    credit_map_[it.first] = ChargingGrant(it.second);
   }
 
-  for (const std::string& rule_id : marshaled.static_rule_ids) {
-    active_static_rules_.push_back(rule_id);
+  active_static_rules_ = std::move(marshaled.static_rule_ids);
+  active_static_rules_set_.reserve(active_static_rules_.size());
+  for (const std::string& rule_id : active_static_rules_) {
+    active_static_rules_set_.insert(rule_id);
   }
   for (auto& rule : marshaled.dynamic_rules) {
     dynamic_rules_.insert_rule(rule);
   }
-  for (auto& rule : marshaled.pdr_list) {
-    pdr_list_.push_back(rule);
-  }
-  for (const std::string& rule_id : marshaled.scheduled_static_rules) {
-    scheduled_static_rules_.insert(rule_id);
-  }
+  pdr_list_ = std::move(marshaled.pdr_list);
+  scheduled_static_rules_ = std::move(marshaled.scheduled_static_rules);
   for (auto& rule : marshaled.scheduled_dynamic_rules) {
     scheduled_dynamic_rules_.insert_rule(rule);
   }
-  for (auto& it : marshaled.rule_lifetimes) {
-    rule_lifetimes_[it.first] = it.second;
-  }
+  rule_lifetimes_ = std::move(marshaled.rule_lifetimes);
   for (auto& rule : marshaled.gy_dynamic_rules) {
     gy_dynamic_rules_.insert_rule(rule);
   }
+  rebuild_credit_update_template();
 }
 
 SessionState::SessionState(
@@ -210,6 +258,7 @@ SessionState::SessionState(
   current_version_        = 0;
   session_level_key_      = "";
   subscriber_quota_state_ = SubscriberQuotaUpdate_Type_VALID_QUOTA;
+  rebuild_credit_update_template();
 }
 
 /*For 5G which doesn't have response context*/
@@ -225,7 +274,9 @@ SessionState::SessionState(
       config_(cfg),
       current_version_(0),
       rtx_counter_(0),
-      static_rules_(rule_store) {}
+      static_rules_(rule_store) {
+  rebuild_credit_update_template();
+}
 
 /* get-set methods of new messages  for 5G*/
 uint32_t SessionState::get_current_version() {
@@ -358,15 +409,13 @@ void SessionState::set_teids(Teids teids) {
   config_.common_context.mutable_teids()->CopyFrom(teids);
 }
 
-static UsageMonitorUpdate make_usage_monitor_update(
+static void fill_usage_monitor_update(
     const Usage& usage_in, const std::string& monitoring_key,
-    MonitoringLevel level) {
-  UsageMonitorUpdate update;
-  update.set_bytes_tx(usage_in.bytes_tx);
-  update.set_bytes_rx(usage_in.bytes_rx);
-  update.set_level(level);
-  update.set_monitoring_key(monitoring_key);
-  return update;
+    MonitoringLevel level, UsageMonitorUpdate* update) {
+  update->set_bytes_tx(usage_in.bytes_tx);
+  update->set_bytes_rx(usage_in.bytes_rx);
+  update->set_level(level);
+  update->set_monitoring_key(monitoring_key);
 }
 
 SessionCreditUpdateCriteria* SessionState::get_credit_uc(
@@ -374,12 +423,28 @@ SessionCreditUpdateCriteria* SessionState::get_credit_uc(
   if (!session_uc) {
     return nullptr;
   }
-  if (session_uc->charging_credit_map.find(key) ==
-      session_uc->charging_credit_map.end()) {
-    session_uc->charging_credit_map[key] =
-        credit_map_[key]->get_update_criteria();
+  // operator[] probes the map once on both hit and miss; the size check
+  // tells us whether the slot was just inserted and still needs filling
+  const size_t size_before          = session_uc->charging_credit_map.size();
+  SessionCreditUpdateCriteria& slot = session_uc->charging_credit_map[key];
+  if (session_uc->charging_credit_map.size() != size_before) {
+    slot = credit_map_[key].get_update_criteria();
+  }
+  return &slot;
+}
+
+SessionCreditUpdateCriteria* SessionState::get_credit_uc(
+    const CreditKey& key, ChargingGrant& grant,
+    SessionStateUpdateCriteria* session_uc) {
+  if (!session_uc) {
+    return nullptr;
+  }
+  const size_t size_before          = session_uc->charging_credit_map.size();
+  SessionCreditUpdateCriteria& slot = session_uc->charging_credit_map[key];
+  if (session_uc->charging_credit_map.size() != size_before) {
+    slot = grant.get_update_criteria();
   }
-  return &(session_uc->charging_credit_map[key]);
+  return &slot;
 }
 
 bool SessionState::apply_update_criteria(
@@ -393,8 +458,9 @@ bool SessionState::apply_update_criteria(
   }
 
   if (session_uc.is_pending_event_triggers_updated) {
-    for (auto it : session_uc.pending_event_triggers) {
-      pending_event_triggers_[it.first] = it.second;
+    for (const auto& it : session_uc.pending_event_triggers) {
+      pending_event_triggers_present_.set(it.first);
+      pending_event_triggers_state_[it.first] = it.second;
       if (it.first == REVALIDATION_TIMEOUT) {
         revalidation_time_ = session_uc.revalidation_time;
       }
@@ -402,12 +468,18 @@ bool SessionState::apply_update_criteria(
   }
   // QoS Management
   if (session_uc.is_bearer_mapping_updated) {
-    bearer_id_by_policy_ = session_uc.bearer_id_by_policy;
+    for (const PolicyID& policy_id : session_uc.bearer_id_by_policy_removed) {
+      bearer_id_by_policy_.erase(policy_id);
+    }
+    for (const auto& it : session_uc.bearer_id_by_policy_added) {
+      bearer_id_by_policy_[it.first] = it.second;
+    }
   }
 
   // Config
   if (session_uc.is_config_updated) {
     config_ = session_uc.updated_config;
+    rebuild_credit_update_template();
   }
 
   // Rule versions
@@ -420,31 +492,31 @@ bool SessionState::apply_update_criteria(
   for (const auto& rule_id : session_uc.static_rules_to_uninstall) {
     if (is_static_rule_installed(rule_id)) {
       remove_from_vec_by_value<std::string>(active_static_rules_, rule_id);
+      active_static_rules_set_.erase(rule_id);
     }
-    if (is_static_rule_scheduled(rule_id)) {
-      scheduled_static_rules_.erase(rule_id);
-    }
+    // erase is a no-op when the rule is not scheduled, so skip the extra
+    // lookup
+    scheduled_static_rules_.erase(rule_id);
     rule_lifetimes_.erase(rule_id);
   }
   for (const auto& rule_id : session_uc.static_rules_to_install) {
     if (!is_static_rule_installed(rule_id)) {
       active_static_rules_.push_back(rule_id);
+      active_static_rules_set_.insert(rule_id);
     }
-    if (session_uc.new_rule_lifetimes.find(rule_id) !=
-        session_uc.new_rule_lifetimes.end()) {
-      rule_lifetimes_[rule_id] = session_uc.new_rule_lifetimes[rule_id];
-    }
-    if (is_static_rule_scheduled(rule_id)) {
-      scheduled_static_rules_.erase(rule_id);
+    auto lifetime_it = session_uc.new_rule_lifetimes.find(rule_id);
+    if (lifetime_it != session_uc.new_rule_lifetimes.end()) {
+      rule_lifetimes_[rule_id] = lifetime_it->second;
     }
+    scheduled_static_rules_.erase(rule_id);
   }
   for (const auto& rule_id : session_uc.new_scheduled_static_rules) {
     if (is_static_rule_scheduled(rule_id)) {
       continue;
     }
-    if (session_uc.new_rule_lifetimes.find(rule_id) !=
-        session_uc.new_rule_lifetimes.end()) {
-      rule_lifetimes_[rule_id] = session_uc.new_rule_lifetimes[rule_id];
+    auto lifetime_it = session_uc.new_rule_lifetimes.find(rule_id);
+    if (lifetime_it != session_uc.new_rule_lifetimes.end()) {
+      rule_lifetimes_[rule_id] = lifetime_it->second;
     }
     scheduled_static_rules_.insert(rule_id);
   }
@@ -456,26 +528,26 @@ bool SessionState::apply_update_criteria(
     rule_lifetimes_.erase(rule_id);
   }
   for (const auto& rule : session_uc.dynamic_rules_to_install) {
-    if (session_uc.new_rule_lifetimes.find(rule.id()) !=
-        session_uc.new_rule_lifetimes.end()) {
-      rule_lifetimes_[rule.id()] = session_uc.new_rule_lifetimes[rule.id()];
+    auto lifetime_it = session_uc.new_rule_lifetimes.find(rule.id());
+    if (lifetime_it != session_uc.new_rule_lifetimes.end()) {
+      rule_lifetimes_[rule.id()] = lifetime_it->second;
     }
     dynamic_rules_.insert_rule(rule);
     scheduled_dynamic_rules_.remove_rule(rule.id(), nullptr);
   }
   for (const auto& rule : session_uc.new_scheduled_dynamic_rules) {
-    if (session_uc.new_rule_lifetimes.find(rule.id()) !=
-        session_uc.new_rule_lifetimes.end()) {
-      rule_lifetimes_[rule.id()] = session_uc.new_rule_lifetimes[rule.id()];
+    auto lifetime_it = session_uc.new_rule_lifetimes.find(rule.id());
+    if (lifetime_it != session_uc.new_rule_lifetimes.end()) {
+      rule_lifetimes_[rule.id()] = lifetime_it->second;
     }
     scheduled_dynamic_rules_.insert_rule(rule);
   }
 
   // Gy Dynamic rules
   for (const auto& rule : session_uc.gy_dynamic_rules_to_install) {
-    if (session_uc.new_rule_lifetimes.find(rule.id()) !=
-        session_uc.new_rule_lifetimes.end()) {
-      rule_lifetimes_[rule.id()] = session_uc.new_rule_lifetimes[rule.id()];
+    auto lifetime_it = session_uc.new_rule_lifetimes.find(rule.id());
+    if (lifetime_it != session_uc.new_rule_lifetimes.end()) {
+      rule_lifetimes_[rule.id()] = lifetime_it->second;
     }
     gy_dynamic_rules_.insert_rule(rule);
   }
@@ -497,16 +569,13 @@ bool SessionState::apply_update_criteria(
   }
   if (session_uc.clear_pdr_list) pdr_list_.clear();
 
-  // Charging credit
+  // Charging credit. Apply entries in place; the old per-entry locals
+  // deep-copied every criteria struct and stored grant before use
   for (const auto& it : session_uc.charging_credit_map) {
-    auto key           = it.first;
-    auto credit_update = it.second;
-    apply_charging_credit_update(key, credit_update);
+    apply_charging_credit_update(it.first, it.second);
   }
   for (const auto& it : session_uc.charging_credit_to_install) {
-    auto key           = it.first;
-    auto stored_credit = it.second;
-    credit_map_[key]   = std::make_unique<ChargingGrant>(stored_credit);
+    credit_map_[it.first] = ChargingGrant(it.second);
   }
 
   // Monitoring credit
@@ -514,14 +583,10 @@ bool SessionState::apply_update_criteria(
     session_level_key_ = session_uc.updated_session_level_key;
   }
   for (const auto& it : session_uc.monitor_credit_map) {
-    auto key           = it.first;
-    auto credit_update = it.second;
-    apply_monitor_updates(key, credit_update);
+    apply_monitor_updates(it.first, it.second);
   }
   for (const auto& it : session_uc.monitor_credit_to_install) {
-    auto key            = it.first;
-    auto stored_monitor = it.second;
-    monitor_map_[key]   = std::make_unique<Monitor>(stored_monitor);
+    monitor_map_[it.first] = Monitor(it.second);
   }
 
   if (session_uc.updated_pdp_end_time > 0) {
@@ -537,7 +602,7 @@ optional<RuleStats> SessionState::get_rule_delta(
     SessionStateUpdateCriteria* session_uc) {
   if (policy_version_and_stats_.find(rule_id) ==
       policy_version_and_stats_.end()) {
-    if (rule_id.compare(DROP_ALL_RULE)) {
+    if (rule_id != DROP_ALL_RULE) {
       // Only log if it's not the drop all rule
       MLOG(MERROR) << "Reported rule (" << rule_id << ") not found in "
                    << session_id_ << ", ignoring";
@@ -606,7 +671,7 @@ void SessionState::add_rule_usage(
     SessionStateUpdateCriteria* session_uc) {
   CreditKey charging_key;
 
-  if (rule_id.compare(DROP_ALL_RULE) == 0) {
+  if (rule_id == DROP_ALL_RULE) {
     set_data_metrics(UE_DROPPED_GAUGE_NAME, dropped_tx, dropped_rx);
     return;
   }
@@ -620,36 +685,46 @@ void SessionState::add_rule_usage(
   }
   RuleStats delta = rule_delta.value();
 
-  if (dynamic_rules_.get_charging_key_for_rule_id(rule_id, &charging_key) ||
-      static_rules_.get_charging_key_for_rule_id(rule_id, &charging_key)) {
+  std::string monitoring_key;
+  bool has_charging_key   = false;
+  bool has_monitoring_key = false;
+  // One lookup per bimap fills both keys, instead of one lookup per key type
+  const bool is_dynamic = dynamic_rules_.get_rule_keys_for_rule_id(
+      rule_id, &charging_key, &has_charging_key, &monitoring_key,
+      &has_monitoring_key);
+  if (!has_charging_key || !has_monitoring_key) {
+    static_rules_.get_rule_keys_for_rule_id(
+        rule_id, &charging_key, &has_charging_key, &monitoring_key,
+        &has_monitoring_key);
+  }
+
+  if (has_charging_key) {
     MLOG(MINFO) << "Updating used charging credit for Rule=" << rule_id
                 << " Rating Group=" << charging_key.rating_group
                 << " Service Identifier=" << charging_key.service_identifier;
     auto it = credit_map_.find(charging_key);
     if (it != credit_map_.end()) {
       SessionCreditUpdateCriteria* credit_uc =
-          get_credit_uc(charging_key, session_uc);
-      it->second->credit.add_used_credit(delta.tx, delta.rx, credit_uc);
-      if (it->second->should_deactivate_service()) {
-        it->second->set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
+          get_credit_uc(charging_key, it->second, session_uc);
+      it->second.credit.add_used_credit(delta.tx, delta.rx, credit_uc);
+      if (it->second.should_deactivate_service()) {
+        it->second.set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
       }
     } else {
       MLOG(MDEBUG) << "Rating Group " << charging_key.rating_group
                    << " not found, not adding the usage";
     }
   }
-  std::string monitoring_key;
-  if (dynamic_rules_.get_monitoring_key_for_rule_id(rule_id, &monitoring_key) ||
-      static_rules_.get_monitoring_key_for_rule_id(rule_id, &monitoring_key)) {
+  if (has_monitoring_key) {
     MLOG(MINFO) << "Updating used monitoring credit for Rule=" << rule_id
                 << " Monitoring Key=" << monitoring_key;
     add_to_monitor(monitoring_key, delta.tx, delta.rx, session_uc);
   }
-  if (session_level_key_ != "" && monitoring_key != session_level_key_) {
+  if (!session_level_key_.empty() && monitoring_key != session_level_key_) {
     // Update session level key if its different
     add_to_monitor(session_level_key_, delta.tx, delta.rx, session_uc);
   }
-  if (is_dynamic_rule_installed(rule_id) || is_static_rule_installed(rule_id)) {
+  if (is_dynamic || is_static_rule_installed(rule_id)) {
     increment_data_metrics(UE_USED_COUNTER_NAME, delta.tx, delta.rx);
   }
   set_data_metrics(UE_DROPPED_GAUGE_NAME, dropped_tx, dropped_rx);
@@ -668,7 +743,7 @@ void SessionState::apply_session_rule_set(
 }
 
 void SessionState::apply_session_static_rule_set(
-    const std::unordered_set<std::string> static_rules,
+    const std::unordered_set<std::string>& static_rules,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup,
     SessionStateUpdateCriteria* session_uc) {
@@ -696,7 +771,7 @@ void SessionState::apply_session_static_rule_set(
   std::vector<PolicyRule> static_pending_deactivation;
 
   // Go through the existing rules and uninstall any rule not in the rule set
-  for (const auto static_rule_id : active_static_rules_) {
+  for (const auto& static_rule_id : active_static_rules_) {
     if (static_rules.find(static_rule_id) == static_rules.end()) {
       PolicyRule rule;
       if (static_rules_.get_rule(static_rule_id, &rule)) {
@@ -721,7 +796,7 @@ void SessionState::apply_session_static_rule_set(
 }
 
 void SessionState::apply_session_dynamic_rule_set(
-    const std::unordered_map<std::string, PolicyRule> dynamic_rules,
+    const std::unordered_map<std::string, PolicyRule>& dynamic_rules,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup,
     SessionStateUpdateCriteria* session_uc) {
@@ -738,14 +813,16 @@ void SessionState::apply_session_dynamic_rule_set(
     classify_policy_activation(
         to_process, DYNAMIC, pending_activation, pending_bearer_setup);
   }
-  std::vector<PolicyRule> active_dynamic_rules;
-  dynamic_rules_.get_rules(active_dynamic_rules);
-  for (const auto& dynamic_rule : active_dynamic_rules) {
-    if (dynamic_rules.find(dynamic_rule.id()) == dynamic_rules.end()) {
-      MLOG(MINFO) << "Removing dynamic rule " << dynamic_rule.id() << " for "
+  // Only the ids are needed for the diff, so avoid materializing a deep
+  // copy of every active PolicyRule proto
+  std::vector<std::string> active_dynamic_rule_ids;
+  dynamic_rules_.get_rule_ids(active_dynamic_rule_ids);
+  for (const std::string& rule_id : active_dynamic_rule_ids) {
+    if (dynamic_rules.find(rule_id) == dynamic_rules.end()) {
+      MLOG(MINFO) << "Removing dynamic rule " << rule_id << " for "
                   << session_id_;
       pending_deactivation->push_back(
-          *remove_dynamic_rule(dynamic_rule.id(), nullptr, session_uc));
+          *remove_dynamic_rule(rule_id, nullptr, session_uc));
     }
   }
 }
@@ -775,12 +852,12 @@ void SessionState::get_monitor_updates(
     UpdateSessionRequest* update_request_out,
     SessionStateUpdateCriteria* session_uc) {
   for (auto& monitor_pair : monitor_map_) {
-    if (!monitor_pair.second->should_send_update()) {
+    if (!monitor_pair.second.should_send_update()) {
       continue;  // no update
     }
 
     auto mkey      = monitor_pair.first;
-    auto& credit   = monitor_pair.second->credit;
+    auto& credit   = monitor_pair.second.credit;
     auto credit_uc = get_monitor_uc(mkey, session_uc);
 
     if (curr_state_ == SESSION_RELEASED) {
@@ -805,13 +882,12 @@ void SessionState::get_monitor_updates(
                  << " with request number " << request_number_
                  << last_update_message;
 
-    auto usage = credit.get_usage_for_reporting(credit_uc);
-    auto update =
-        make_usage_monitor_update(usage, mkey, monitor_pair.second->level);
+    auto usage   = credit.get_usage_for_reporting(credit_uc);
     auto new_req = update_request_out->mutable_usage_monitors()->Add();
 
     add_common_fields_to_usage_monitor_update(new_req);
-    new_req->mutable_update()->CopyFrom(update);
+    fill_usage_monitor_update(
+        usage, mkey, monitor_pair.second.level, new_req->mutable_update());
     new_req->set_event_trigger(USAGE_REPORT);
     request_number_++;
     if (session_uc) {
@@ -822,11 +898,12 @@ void SessionState::get_monitor_updates(
 
 void SessionState::add_common_fields_to_usage_monitor_update(
     UsageMonitoringUpdateRequest* req) {
+  const auto& common = config_.common_context;
   req->set_session_id(session_id_);
   req->set_request_number(request_number_);
   req->set_sid(get_imsi());
-  req->set_ue_ipv4(config_.common_context.ue_ipv4());
-  req->set_rat_type(config_.common_context.rat_type());
+  req->set_ue_ipv4(common.ue_ipv4());
+  req->set_rat_type(common.rat_type());
   fill_protos_tgpp_context(req->mutable_tgpp_ctx());
   if (config_.rat_specific_context.has_wlan_context()) {
     const auto& wlan_context = config_.rat_specific_context.wlan_context();
@@ -893,21 +970,24 @@ SessionTerminateRequest SessionState::make_termination_request(
   }
 
   // gx monitors
+  req.mutable_monitor_usages()->Reserve(monitor_map_.size());
   for (auto& credit_pair : monitor_map_) {
     auto credit_uc = get_monitor_uc(credit_pair.first, session_uc);
-    req.mutable_monitor_usages()->Add()->CopyFrom(make_usage_monitor_update(
-        credit_pair.second->credit.get_all_unreported_usage_for_reporting(
+    fill_usage_monitor_update(
+        credit_pair.second.credit.get_all_unreported_usage_for_reporting(
             credit_uc),
-        credit_pair.first, credit_pair.second->level));
+        credit_pair.first, credit_pair.second.level,
+        req.mutable_monitor_usages()->Add());
   }
   // gy credits
+  req.mutable_credit_usages()->Reserve(credit_map_.size());
   for (auto& credit_pair : credit_map_) {
     SessionCreditUpdateCriteria* credit_uc =
         get_credit_uc(credit_pair.first, session_uc);
-    auto credit_usage = credit_pair.second->get_credit_usage(
+    auto credit_usage = credit_pair.second.get_credit_usage(
         CreditUsage::TERMINATED, credit_uc, true);
     credit_pair.first.set_credit_usage(&credit_usage);
-    req.mutable_credit_usages()->Add()->CopyFrom(credit_usage);
+    *req.mutable_credit_usages()->Add() = std::move(credit_usage);
   }
   return req;
 }
@@ -916,62 +996,57 @@ ChargingCreditSummaries SessionState::get_charging_credit_summaries() {
   ChargingCreditSummaries charging_credit_summaries(
       credit_map_.size(), &ccHash, &ccEqual);
   for (auto& credit_pair : credit_map_) {
-    auto summary = credit_pair.second->credit.get_credit_summary();
+    auto summary = credit_pair.second.credit.get_credit_summary();
     charging_credit_summaries[credit_pair.first] = summary;
   }
   return charging_credit_summaries;
 }
 
 TotalCreditUsage SessionState::get_total_credit_usage() {
-  // Collate unique charging/monitoring keys used by rules
-  std::unordered_set<CreditKey, decltype(&ccHash), decltype(&ccEqual)>
-      used_charging_keys(4, ccHash, ccEqual);
-  std::unordered_set<std::string> used_monitoring_keys;
+  TotalCreditUsage usage{
+      .monitoring_tx = 0,
+      .monitoring_rx = 0,
+      .charging_tx   = 0,
+      .charging_rx   = 0,
+  };
+  // Sum while walking the rules; the sets only dedupe keys shared by
+  // several rules, so each key is looked up in the credit maps exactly once
+  folly::F14FastSet<CreditKey, decltype(&ccHash), decltype(&ccEqual)>
+      counted_charging_keys(4, &ccHash, &ccEqual);
+  folly::F14FastSet<std::string> counted_monitoring_keys;
 
   std::vector<std::reference_wrapper<PolicyRuleBiMap>> bimaps{static_rules_,
                                                               dynamic_rules_};
-
+  std::vector<std::string> rule_ids;
   for (auto bimap : bimaps) {
     PolicyRuleBiMap& rules = bimap;
-    std::vector<std::string> rule_ids{};
-    std::vector<std::string>& rule_ids_ptr = rule_ids;
-    rules.get_rule_ids(rule_ids_ptr);
+    rule_ids.clear();
+    rules.get_rule_ids(rule_ids);
 
-    for (auto rule_id : rule_ids) {
+    for (const std::string& rule_id : rule_ids) {
       CreditKey charging_key;
-      bool should_track_charging_key =
-          rules.get_charging_key_for_rule_id(rule_id, &charging_key);
       std::string monitoring_key;
-      bool should_track_monitoring_key =
-          rules.get_monitoring_key_for_rule_id(rule_id, &monitoring_key);
-
-      if (should_track_charging_key) {
-        used_charging_keys.insert(charging_key);
+      bool has_charging_key   = false;
+      bool has_monitoring_key = false;
+      rules.get_rule_keys_for_rule_id(
+          rule_id, &charging_key, &has_charging_key, &monitoring_key,
+          &has_monitoring_key);
+
+      if (has_charging_key &&
+          counted_charging_keys.insert(charging_key).second) {
+        auto it = credit_map_.find(charging_key);
+        if (it != credit_map_.end()) {
+          usage.charging_tx += it->second.credit.get_credit(USED_TX);
+          usage.charging_rx += it->second.credit.get_credit(USED_RX);
+        }
       }
-      if (should_track_monitoring_key) {
-        used_monitoring_keys.insert(monitoring_key);
+      if (has_monitoring_key &&
+          counted_monitoring_keys.insert(monitoring_key).second) {
+        usage.monitoring_tx += get_monitor(monitoring_key, USED_TX);
+        usage.monitoring_rx += get_monitor(monitoring_key, USED_RX);
       }
     }
   }
-
-  // Sum up usage
-  TotalCreditUsage usage{
-      .monitoring_tx = 0,
-      .monitoring_rx = 0,
-      .charging_tx   = 0,
-      .charging_rx   = 0,
-  };
-  for (auto monitoring_key : used_monitoring_keys) {
-    usage.monitoring_tx += get_monitor(monitoring_key, USED_TX);
-    usage.monitoring_rx += get_monitor(monitoring_key, USED_RX);
-  }
-  for (auto charging_key : used_charging_keys) {
-    auto it = credit_map_.find(charging_key);
-    if (it != credit_map_.end()) {
-      usage.charging_tx += it->second->credit.get_credit(USED_TX);
-      usage.charging_rx += it->second->credit.get_credit(USED_RX);
-    }
-  }
   return usage;
 }
 
@@ -1005,6 +1080,7 @@ void SessionState::set_upf_teid_endpoint(
 
 void SessionState::set_config(const SessionConfig& config) {
   config_ = config;
+  rebuild_credit_update_template();
 }
 
 bool SessionState::is_radius_cwf_session() const {
@@ -1013,29 +1089,35 @@ bool SessionState::is_radius_cwf_session() const {
 
 SessionState::SessionInfo SessionState::get_session_info() {
   SessionState::SessionInfo info;
+  const auto& common = config_.common_context;
   info.imsi      = get_imsi();
-  info.ip_addr   = config_.common_context.ue_ipv4();
-  info.ipv6_addr = config_.common_context.ue_ipv6();
-  info.teids     = config_.common_context.teids();
-  info.msisdn    = config_.common_context.msisdn();
+  info.ip_addr   = common.ue_ipv4();
+  info.ipv6_addr = common.ue_ipv6();
+  info.teids     = common.teids();
+  info.msisdn    = common.msisdn();
   info.ambr      = config_.get_apn_ambr();
 
-  std::vector<PolicyRule> gx_dynamic_rules, gy_dynamic_rules;
-  dynamic_rules_.get_rules(gx_dynamic_rules);
-  gy_dynamic_rules_.get_rules(gy_dynamic_rules);
+  // Reference the stored rules instead of copying each proto; the only copy
+  // left per rule is the one into RuleToProcess, which owns its PolicyRule
+  std::vector<std::shared_ptr<const PolicyRule>> gx_dynamic_rules,
+      gy_dynamic_rules;
+  dynamic_rules_.get_rule_ptrs(gx_dynamic_rules);
+  gy_dynamic_rules_.get_rule_ptrs(gy_dynamic_rules);
 
   // Set versions
-  for (const PolicyRule rule : gx_dynamic_rules) {
-    info.gx_rules.push_back(make_rule_to_process(rule));
+  info.gx_rules.reserve(gx_dynamic_rules.size() + active_static_rules_.size());
+  for (const auto& rule : gx_dynamic_rules) {
+    info.gx_rules.push_back(make_rule_to_process(*rule));
   }
-  for (const PolicyRule rule : gy_dynamic_rules) {
-    info.gy_dynamic_rules.push_back(make_rule_to_process(rule));
+  info.gy_dynamic_rules.reserve(gy_dynamic_rules.size());
+  for (const auto& rule : gy_dynamic_rules) {
+    info.gy_dynamic_rules.push_back(make_rule_to_process(*rule));
   }
 
   for (const std::string& rule_id : active_static_rules_) {
-    PolicyRule rule;
-    if (static_rules_.get_rule(rule_id, &rule)) {
-      info.gx_rules.push_back(make_rule_to_process(rule));
+    std::shared_ptr<const PolicyRule> rule = static_rules_.get_rule_ptr(rule_id);
+    if (rule) {
+      info.gx_rules.push_back(make_rule_to_process(*rule));
     }
   }
   return info;
@@ -1066,7 +1148,10 @@ void SessionState::remove_all_rules_for_termination(
   for (PolicyRule& policy : gy_dynamic_rules) {
     remove_gy_rule(policy.id(), nullptr, session_uc);
   }
-  for (const std::string& rule_id : active_static_rules_) {
+  // deactivate_static_rule erases from active_static_rules_, so iterate a
+  // copy
+  const std::vector<std::string> static_rules_to_remove = active_static_rules_;
+  for (const std::string& rule_id : static_rules_to_remove) {
     deactivate_static_rule(rule_id, session_uc);
   }
 
@@ -1087,6 +1172,7 @@ void SessionState::set_tgpp_context(
     session_uc->updated_tgpp_context = tgpp_context;
   }
   tgpp_context_ = tgpp_context;
+  rebuild_credit_update_template();
 }
 
 void SessionState::fill_protos_tgpp_context(
@@ -1143,9 +1229,7 @@ bool SessionState::is_gy_dynamic_rule_installed(const std::string& rule_id) {
 }
 
 bool SessionState::is_static_rule_installed(const std::string& rule_id) {
-  return std::find(
-             active_static_rules_.begin(), active_static_rules_.end(),
-             rule_id) != active_static_rules_.end();
+  return active_static_rules_set_.count(rule_id) > 0;
 }
 
 RuleToProcess SessionState::insert_dynamic_rule(
@@ -1186,6 +1270,7 @@ RuleToProcess SessionState::activate_static_rule(
   rule_lifetimes_[rule_id] = lifetime;
   if (!is_static_rule_installed(rule_id)) {
     active_static_rules_.push_back(rule_id);
+    active_static_rules_set_.insert(rule_id);
   }
   if (session_uc) {
     session_uc->static_rules_to_install.insert(rule_id);
@@ -1246,15 +1331,14 @@ optional<RuleToProcess> SessionState::remove_gy_rule(
 
 optional<RuleToProcess> SessionState::deactivate_static_rule(
     const std::string rule_id, SessionStateUpdateCriteria* session_uc) {
-  auto it = std::find(
-      active_static_rules_.begin(), active_static_rules_.end(), rule_id);
-  if (it == active_static_rules_.end()) {
+  // O(1) membership check; the ordered vector is only walked on a hit
+  if (active_static_rules_set_.erase(rule_id) == 0) {
     return {};
   }
   if (session_uc) {
     session_uc->static_rules_to_uninstall.insert(rule_id);
   }
-  active_static_rules_.erase(it);
+  remove_from_vec_by_value<std::string>(active_static_rules_, rule_id);
 
   increment_rule_stats(rule_id, session_uc);
 
@@ -1276,11 +1360,9 @@ RuleToProcess SessionState::make_rule_to_process(const PolicyRule& rule) {
   PolicyType p_type = is_static ? STATIC : DYNAMIC;
 
   // If there is a dedicated bearer TEID already in map, use it
-  PolicyID policy_id = PolicyID(p_type, rule.id());
-  bool dedicated_bearer_exists =
-      bearer_id_by_policy_.find(policy_id) != bearer_id_by_policy_.end();
-  if (dedicated_bearer_exists) {
-    to_process.teids = bearer_id_by_policy_[policy_id].teids;
+  auto bearer_it = bearer_id_by_policy_.find(PolicyID(p_type, rule.id()));
+  if (bearer_it != bearer_id_by_policy_.end()) {
+    to_process.teids = bearer_it->second.teids;
   } else {
     to_process.teids = config_.common_context.teids();
   }
@@ -1308,8 +1390,10 @@ void SessionState::classify_policy_activation(
 }
 
 void SessionState::process_rules_to_install(
-    const std::vector<StaticRuleInstall>& static_rule_installs,
-    const std::vector<DynamicRuleInstall>& dynamic_rule_installs,
+    const google::protobuf::RepeatedPtrField<StaticRuleInstall>&
+        static_rule_installs,
+    const google::protobuf::RepeatedPtrField<DynamicRuleInstall>&
+        dynamic_rule_installs,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
     SessionStateUpdateCriteria* session_uc) {
@@ -1322,7 +1406,8 @@ void SessionState::process_rules_to_install(
 }
 
 void SessionState::process_static_rule_installs(
-    const std::vector<StaticRuleInstall>& rule_installs,
+    const google::protobuf::RepeatedPtrField<StaticRuleInstall>&
+        rule_installs,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
     SessionStateUpdateCriteria* session_uc) {
@@ -1338,8 +1423,9 @@ void SessionState::process_static_rule_installs(
                      << " since it is alreday installed";
       continue;
     }
-    PolicyRule static_rule;
-    if (!static_rules_.get_rule(rule_id, &static_rule)) {
+    // Existence check only: pass nullptr so the store does not copy the
+    // whole PolicyRule per install
+    if (!static_rules_.get_rule(rule_id, nullptr)) {
       MLOG(MERROR) << "static rule " << rule_id
                    << " is not found, skipping install...";
       continue;
@@ -1377,7 +1463,8 @@ void SessionState::process_static_rule_installs(
 }
 
 void SessionState::process_dynamic_rule_installs(
-    const std::vector<DynamicRuleInstall>& rule_installs,
+    const google::protobuf::RepeatedPtrField<DynamicRuleInstall>&
+        rule_installs,
     RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
     RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
     SessionStateUpdateCriteria* session_uc) {
@@ -1420,7 +1507,7 @@ void SessionState::process_dynamic_rule_installs(
 }
 
 void SessionState::process_rules_to_remove(
-    const google::protobuf::RepeatedPtrField<std::basic_string<char>>
+    const google::protobuf::RepeatedPtrField<std::basic_string<char>>&
         rules_to_remove,
     RulesToProcess* pending_deactivation,
     SessionStateUpdateCriteria* session_uc) {
@@ -1457,28 +1544,58 @@ void SessionState::process_rules_to_remove(
 
 void SessionState::sync_rules_to_time(
     std::time_t current_time, SessionStateUpdateCriteria* session_uc) {
+  // Each rule's lifetime is looked up exactly once per sync; rules without a
+  // tracked lifetime are skipped instead of default-inserting an entry
   // Update active static rules
+  std::vector<std::string> static_rules_to_deactivate;
   for (const std::string& rule_id : active_static_rules_) {
-    if (should_rule_be_deactivated(rule_id, current_time)) {
-      deactivate_static_rule(rule_id, session_uc);
+    auto lifetime_it = rule_lifetimes_.find(rule_id);
+    if (lifetime_it == rule_lifetimes_.end()) {
+      continue;
     }
+    if (should_rule_be_deactivated(lifetime_it->second, current_time)) {
+      static_rules_to_deactivate.push_back(rule_id);
+    }
+  }
+  // Do the actual removal separately so we're not erasing from the vector
+  // while looping over it
+  for (const std::string& rule_id : static_rules_to_deactivate) {
+    deactivate_static_rule(rule_id, session_uc);
   }
-  // Update scheduled static rules
-  std::set<std::string> scheduled_rule_ids = scheduled_static_rules_;
-  for (const std::string& rule_id : scheduled_rule_ids) {
-    if (should_rule_be_active(rule_id, current_time)) {
-      scheduled_static_rules_.erase(rule_id);
-      activate_static_rule(rule_id, rule_lifetimes_[rule_id], session_uc);
-    } else if (should_rule_be_deactivated(rule_id, current_time)) {
-      scheduled_static_rules_.erase(rule_id);
-      deactivate_static_rule(rule_id, session_uc);
+  // Update scheduled static rules. Collect the transitions first so the set
+  // is read-only while iterated, instead of deep-copying it every sync
+  std::vector<std::pair<std::string, RuleLifetime>> scheduled_to_activate;
+  std::vector<std::string> scheduled_to_deactivate;
+  for (const std::string& rule_id : scheduled_static_rules_) {
+    auto lifetime_it = rule_lifetimes_.find(rule_id);
+    if (lifetime_it == rule_lifetimes_.end()) {
+      continue;
     }
+    const RuleLifetime& lifetime = lifetime_it->second;
+    if (should_rule_be_active(lifetime, current_time)) {
+      scheduled_to_activate.emplace_back(rule_id, lifetime);
+    } else if (should_rule_be_deactivated(lifetime, current_time)) {
+      scheduled_to_deactivate.push_back(rule_id);
+    }
+  }
+  for (const auto& rule_and_lifetime : scheduled_to_activate) {
+    scheduled_static_rules_.erase(rule_and_lifetime.first);
+    activate_static_rule(
+        rule_and_lifetime.first, rule_and_lifetime.second, session_uc);
+  }
+  for (const std::string& rule_id : scheduled_to_deactivate) {
+    scheduled_static_rules_.erase(rule_id);
+    deactivate_static_rule(rule_id, session_uc);
   }
   // Update active dynamic rules
   std::vector<std::string> dynamic_rule_ids;
   dynamic_rules_.get_rule_ids(dynamic_rule_ids);
   for (const std::string& rule_id : dynamic_rule_ids) {
-    if (should_rule_be_deactivated(rule_id, current_time)) {
+    auto lifetime_it = rule_lifetimes_.find(rule_id);
+    if (lifetime_it == rule_lifetimes_.end()) {
+      continue;
+    }
+    if (should_rule_be_deactivated(lifetime_it->second, current_time)) {
       remove_dynamic_rule(rule_id, nullptr, session_uc);
     }
   }
@@ -1486,21 +1603,27 @@ void SessionState::sync_rules_to_time(
   dynamic_rule_ids.clear();
   scheduled_dynamic_rules_.get_rule_ids(dynamic_rule_ids);
   for (const std::string& rule_id : dynamic_rule_ids) {
-    if (should_rule_be_active(rule_id, current_time)) {
+    auto lifetime_it = rule_lifetimes_.find(rule_id);
+    if (lifetime_it == rule_lifetimes_.end()) {
+      continue;
+    }
+    const RuleLifetime& lifetime = lifetime_it->second;
+    if (should_rule_be_active(lifetime, current_time)) {
       PolicyRule dy_rule;
       remove_scheduled_dynamic_rule(rule_id, &dy_rule, session_uc);
-      insert_dynamic_rule(dy_rule, rule_lifetimes_[rule_id], session_uc);
-    } else if (should_rule_be_deactivated(rule_id, current_time)) {
+      insert_dynamic_rule(dy_rule, lifetime, session_uc);
+    } else if (should_rule_be_deactivated(lifetime, current_time)) {
       remove_scheduled_dynamic_rule(rule_id, nullptr, session_uc);
     }
   }
 }
 
-std::vector<std::string>& SessionState::get_static_rules() {
+const std::vector<std::string>& SessionState::get_static_rules() const {
   return active_static_rules_;
 }
 
-std::set<std::string>& SessionState::get_scheduled_static_rules() {
+const folly::F14FastSet<std::string>& SessionState::get_scheduled_static_rules()
+    const {
   return scheduled_static_rules_;
 }
 
@@ -1512,8 +1635,11 @@ DynamicRuleStore& SessionState::get_scheduled_dynamic_rules() {
   return scheduled_dynamic_rules_;
 }
 
-RuleLifetime& SessionState::get_rule_lifetime(const std::string& rule_id) {
-  return rule_lifetimes_[rule_id];
+RuleLifetime SessionState::get_rule_lifetime(const std::string& rule_id) const {
+  auto it = rule_lifetimes_.find(rule_id);
+  // Missing lifetimes used to be default-inserted by operator[]; keep the
+  // always-active default without growing the map for unknown rule IDs
+  return it == rule_lifetimes_.end() ? RuleLifetime() : it->second;
 }
 
 DynamicRuleStore& SessionState::get_gy_dynamic_rules() {
@@ -1522,12 +1648,9 @@ DynamicRuleStore& SessionState::get_gy_dynamic_rules() {
 
 uint32_t SessionState::total_monitored_rules_count() {
   uint32_t monitored_dynamic_rules = dynamic_rules_.monitored_rules_count();
-  uint32_t monitored_static_rules  = 0;
-  for (auto& rule_id : active_static_rules_) {
-    if (static_rules_.get_monitoring_key_for_rule_id(rule_id, nullptr)) {
-      monitored_static_rules++;
-    }
-  }
+  // one store lock for the whole batch instead of one per active rule
+  uint32_t monitored_static_rules =
+      static_rules_.monitored_rules_count_for_ids(active_static_rules_);
   return monitored_dynamic_rules + monitored_static_rules;
 }
 
@@ -1585,24 +1708,35 @@ void SessionState::suspend_service_if_needed_for_credit(
                  << " Not suspending service for " << session_id_;
   }
   for (const auto& credit : credit_map_) {
-    if (credit.second->suspended) {
+    if (credit.second.suspended) {
       suspended_count++;
     }
   }
   if (credit_map_.size() > 0 && suspended_count == credit_map_.size()) {
-    it->second->set_service_state(
+    it->second.set_service_state(
         SERVICE_NEEDS_SUSPENSION, get_credit_uc(ckey, session_uc));
   }
 }
 
 bool SessionState::should_rule_be_active(
-    const std::string& rule_id, std::time_t time) {
-  return rule_lifetimes_[rule_id].is_within_lifetime(time);
+    const RuleLifetime& lifetime, std::time_t time) {
+  return lifetime.is_within_lifetime(time);
+}
+
+bool SessionState::should_rule_be_active(
+    const std::string& rule_id, std::time_t time) const {
+  auto lifetime_it = rule_lifetimes_.find(rule_id);
+  if (lifetime_it == rule_lifetimes_.end()) {
+    // no activation window recorded; matches the default-constructed
+    // lifetime the old operator[] lookup handed back, without the insert
+    return true;
+  }
+  return should_rule_be_active(lifetime_it->second, time);
 }
 
 bool SessionState::should_rule_be_deactivated(
-    const std::string& rule_id, std::time_t time) {
-  return rule_lifetimes_[rule_id].exceeded_lifetime(time);
+    const RuleLifetime& lifetime, std::time_t time) {
+  return lifetime.exceeded_lifetime(time);
 }
 
 StaticRuleInstall SessionState::get_static_rule_install(
@@ -1654,10 +1788,10 @@ std::vector<PolicyRule> SessionState::get_all_final_unit_rules() {
   std::vector<PolicyRule> rules;
   for (auto& credit_pair : credit_map_) {
     auto& grant = credit_pair.second;
-    if (grant->service_state != SERVICE_RESTRICTED) {
+    if (grant.service_state != SERVICE_RESTRICTED) {
       continue;
     }
-    for (const std::string rule_id : grant->final_action_info.restrict_rules) {
+    for (const std::string& rule_id : grant.final_action_info.restrict_rules) {
       PolicyRule rule;
       if (static_rules_.get_rule(rule_id, &rule)) {
         rules.push_back(rule);
@@ -1683,7 +1817,7 @@ void SessionState::handle_update_failure(
                    << session_id_;
       continue;
     }
-    credit_map_[key]->reset_reporting_grant(get_credit_uc(key, session_uc));
+    credit_map_[key].reset_reporting_grant(get_credit_uc(key, session_uc));
   }
   for (const auto& failed_monitor : failed_requests.monitor_requests) {
     const auto key = failed_monitor.update().monitoring_key();
@@ -1692,7 +1826,7 @@ void SessionState::handle_update_failure(
                    << session_id_;
       continue;
     }
-    monitor_map_[key]->credit.reset_reporting_credit(
+    monitor_map_[key].credit.reset_reporting_credit(
         get_monitor_uc(key, session_uc));
   }
 }
@@ -1708,37 +1842,40 @@ bool SessionState::receive_charging_credit(
     return init_charging_credit(update, session_uc);
   }
 
-  auto& grant                            = it->second;
-  SessionCreditUpdateCriteria* credit_uc = get_credit_uc(key, session_uc);
+  auto& grant = it->second;
+  // reuse the entry found above instead of hashing the key a second time
+  SessionCreditUpdateCriteria* credit_uc = get_credit_uc(key, grant, session_uc);
   auto credit_validity = ChargingGrant::is_valid_credit_response(update);
   if (credit_validity == INVALID_CREDIT) {
     // update unsuccessful, reset credit and return
-    grant->credit.mark_failure(update.result_code(), credit_uc);
-    if (grant->should_deactivate_service()) {
-      grant->set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
+    grant.credit.mark_failure(update.result_code(), credit_uc);
+    if (grant.should_deactivate_service()) {
+      grant.set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
     }
     return false;
   }
   if (credit_validity == TRANSIENT_ERROR) {
     // for transient errors, try to install the credit
     // but clear the reported credit
-    grant->credit.mark_failure(update.result_code(), credit_uc);
+    grant.credit.mark_failure(update.result_code(), credit_uc);
   }
-  grant->receive_charging_grant(update, credit_uc);
+  grant.receive_charging_grant(update, credit_uc);
 
-  if (grant->reauth_state == REAUTH_PROCESSING) {
-    grant->set_reauth_state(REAUTH_NOT_NEEDED, credit_uc);
+  if (grant.reauth_state == REAUTH_PROCESSING) {
+    grant.set_reauth_state(REAUTH_NOT_NEEDED, credit_uc);
   }
-  if (!grant->credit.is_quota_exhausted(1) &&
-      grant->service_state != SERVICE_ENABLED) {
+  // is_quota_exhausted walks the credit buckets, so evaluate it once and
+  // feed the result to both the re-enable and the deactivation checks
+  const bool quota_exhausted = grant.credit.is_quota_exhausted(1);
+  if (!quota_exhausted && grant.service_state != SERVICE_ENABLED) {
     // if quota no longer exhausted, re-enable services as needed
     MLOG(MINFO) << "New quota now available. Service is in state: "
-                << service_state_to_str(grant->service_state)
+                << service_state_to_str(grant.service_state)
                 << " Activating service RG: " << key << " for " << session_id_;
-    grant->set_service_state(SERVICE_NEEDS_ACTIVATION, credit_uc);
+    grant.set_service_state(SERVICE_NEEDS_ACTIVATION, credit_uc);
   }
-  if (grant->should_deactivate_service()) {
-    grant->set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
+  if (grant.should_deactivate_service(quota_exhausted)) {
+    grant.set_service_state(SERVICE_NEEDS_DEACTIVATION, credit_uc);
   }
   return true;
 }
@@ -1746,22 +1883,20 @@ bool SessionState::receive_charging_credit(
 bool SessionState::init_charging_credit(
     const CreditUpdateResponse& update,
     SessionStateUpdateCriteria* session_uc) {
-  const uint32_t key = update.charging_key();
   if (ChargingGrant::is_valid_credit_response(update) == INVALID_CREDIT) {
     // init failed, don't track key
     return false;
   }
+  const CreditKey key = CreditKey(update);
   ChargingGrant charging_grant;
   charging_grant.credit = SessionCredit(SERVICE_ENABLED, update.limit_type());
   charging_grant.receive_charging_grant(update);
   if (session_uc) {
-    session_uc->charging_credit_to_install[CreditKey(update)] =
-        charging_grant.marshal();
+    session_uc->charging_credit_to_install[key] = charging_grant.marshal();
   }
-  credit_map_[CreditKey(update)] =
-      std::make_unique<ChargingGrant>(charging_grant);
-  MLOG(MINFO) << "Initialized a new credit RG:" << key << " for "
-              << session_id_;
+  credit_map_[key] = std::move(charging_grant);
+  MLOG(MINFO) << "Initialized a new credit RG:" << update.charging_key()
+              << " for " << session_id_;
   return true;
 }
 
@@ -1771,7 +1906,7 @@ void SessionState::set_suspend_credit(
   auto it = credit_map_.find(charging_key);
   if (it != credit_map_.end()) {
     auto& grant = it->second;
-    grant->set_suspended(
+    grant.set_suspended(
         new_suspended, get_credit_uc(charging_key, session_uc));
   }
 }
@@ -1780,7 +1915,7 @@ bool SessionState::is_credit_suspended(const CreditKey& charging_key) {
   auto it = credit_map_.find(charging_key);
   if (it != credit_map_.end()) {
     auto& grant = it->second;
-    return grant->get_suspended();
+    return grant.get_suspended();
   }
   return false;
 }
@@ -1790,7 +1925,7 @@ bool SessionState::is_credit_ready_to_be_activated(
   auto it = credit_map_.find(charging_key);
   if (it != credit_map_.end()) {
     auto& grant = it->second;
-    return grant->should_be_unsuspended();
+    return grant.should_be_unsuspended();
   }
   return false;
 }
@@ -1824,7 +1959,7 @@ uint64_t SessionState::get_charging_credit(
   if (it == credit_map_.end()) {
     return 0;
   }
-  return it->second->credit.get_credit(bucket);
+  return it->second.credit.get_credit(bucket);
 }
 
 bool SessionState::set_credit_reporting(
@@ -1837,7 +1972,7 @@ bool SessionState::set_credit_reporting(
     return false;
   }
 
-  it->second->credit.set_reporting(reporting);
+  it->second.credit.set_reporting(reporting);
   if (session_uc) {
     get_credit_uc(key, session_uc)->reporting = reporting;
   }
@@ -1850,20 +1985,20 @@ ReAuthResult SessionState::reauth_key(
   if (it != credit_map_.end()) {
     // if credit is already reporting, don't initiate update
     auto& grant = it->second;
-    if (grant->credit.is_reporting()) {
+    if (grant.credit.is_reporting()) {
       return ReAuthResult::UPDATE_NOT_NEEDED;
     }
-    grant->set_reauth_state(
-        REAUTH_REQUIRED, get_credit_uc(charging_key, session_uc));
+    grant.set_reauth_state(
+        REAUTH_REQUIRED, get_credit_uc(charging_key, grant, session_uc));
     return ReAuthResult::UPDATE_INITIATED;
   }
   // charging_key cannot be found, initialize credit and engage reauth
-  auto grant           = std::make_unique<ChargingGrant>();
-  grant->credit        = SessionCredit(SERVICE_DISABLED);
-  grant->reauth_state  = REAUTH_REQUIRED;
-  grant->service_state = SERVICE_DISABLED;
+  ChargingGrant grant;
+  grant.credit        = SessionCredit(SERVICE_DISABLED);
+  grant.reauth_state  = REAUTH_REQUIRED;
+  grant.service_state = SERVICE_DISABLED;
   if (session_uc) {
-    session_uc->charging_credit_to_install[charging_key] = grant->marshal();
+    session_uc->charging_credit_to_install[charging_key] = grant.marshal();
   }
   credit_map_[charging_key] = std::move(grant);
   return ReAuthResult::UPDATE_INITIATED;
@@ -1872,11 +2007,12 @@ ReAuthResult SessionState::reauth_key(
 ReAuthResult SessionState::reauth_all(SessionStateUpdateCriteria* session_uc) {
   auto res = ReAuthResult::UPDATE_NOT_NEEDED;
   for (auto& credit_pair : credit_map_) {
-    auto key    = credit_pair.first;
-    auto& grant = credit_pair.second;
+    const auto& key = credit_pair.first;
+    auto& grant     = credit_pair.second;
     // Only update credits that aren't reporting
-    if (!grant->credit.is_reporting()) {
-      grant->set_reauth_state(REAUTH_REQUIRED, get_credit_uc(key, session_uc));
+    if (!grant.credit.is_reporting()) {
+      grant.set_reauth_state(REAUTH_REQUIRED,
+                             get_credit_uc(key, grant, session_uc));
       res = ReAuthResult::UPDATE_INITIATED;
     }
   }
@@ -1891,31 +2027,29 @@ void SessionState::apply_charging_credit_update(
   }
 
   if (credit_uc.deleted) {
-    credit_map_.erase(key);
+    credit_map_.erase(it);
     MLOG(MINFO) << session_id_ << " Erasing RG " << key;
     return;
   }
 
   auto& charging_grant = it->second;
-  auto& credit         = charging_grant->credit;
+  auto& credit         = charging_grant.credit;
 
   // Credit merging
   credit.apply_update_criteria(credit_uc);
 
   // set charging grant
-  charging_grant->is_final_grant    = credit_uc.is_final;
-  charging_grant->final_action_info = credit_uc.final_action_info;
-  charging_grant->expiry_time       = credit_uc.expiry_time;
-  charging_grant->reauth_state      = credit_uc.reauth_state;
-  charging_grant->service_state     = credit_uc.service_state;
-  charging_grant->suspended         = credit_uc.suspended;
+  charging_grant.is_final_grant    = credit_uc.is_final;
+  charging_grant.final_action_info = credit_uc.final_action_info;
+  charging_grant.expiry_time       = credit_uc.expiry_time;
+  charging_grant.reauth_state      = credit_uc.reauth_state;
+  charging_grant.service_state     = credit_uc.service_state;
+  charging_grant.suspended         = credit_uc.suspended;
 }
 
-CreditUsageUpdate SessionState::make_credit_usage_update_req(
-    CreditUsage& usage) const {
+void SessionState::rebuild_credit_update_template() {
   CreditUsageUpdate req;
   req.set_session_id(session_id_);
-  req.set_request_number(request_number_);
   fill_protos_tgpp_context(req.mutable_tgpp_ctx());
   req.mutable_common_context()->CopyFrom(config_.common_context);
 
@@ -1933,7 +2067,18 @@ CreditUsageUpdate SessionState::make_credit_usage_update_req(
     const auto& wlan_context = config_.rat_specific_context.wlan_context();
     req.set_hardware_addr(wlan_context.mac_addr_binary());
   }
-  req.mutable_usage()->CopyFrom(usage);
+  credit_update_template_.Swap(&req);
+}
+
+CreditUsageUpdate SessionState::make_credit_usage_update_req(
+    CreditUsage& usage) const {
+  // One deep copy of the prebuilt template instead of refilling the stable
+  // session/config fields for every update
+  CreditUsageUpdate req = credit_update_template_;
+  req.set_request_number(request_number_);
+  // The caller's CreditUsage is built for this request only, so take it over
+  // instead of deep-copying it
+  req.mutable_usage()->Swap(&usage);
   return req;
 }
 
@@ -1941,13 +2086,19 @@ void SessionState::get_charging_updates(
     UpdateSessionRequest* update_request_out,
     std::vector<std::unique_ptr<ServiceAction>>* actions_out,
     SessionStateUpdateCriteria* session_uc) {
+  // At most one update per credit; reserving up front keeps the repeated
+  // field's pointer array from growing step by step as updates are added
+  update_request_out->mutable_updates()->Reserve(
+      update_request_out->updates_size() + credit_map_.size());
   for (auto& credit_pair : credit_map_) {
-    auto& key                              = credit_pair.first;
-    auto& grant                            = credit_pair.second;
-    SessionCreditUpdateCriteria* credit_uc = get_credit_uc(key, session_uc);
+    auto& key   = credit_pair.first;
+    auto& grant = credit_pair.second;
+    SessionCreditUpdateCriteria* credit_uc =
+        get_credit_uc(key, grant, session_uc);
 
-    auto action_type = grant->get_action(credit_uc);
-    auto action      = std::make_unique<ServiceAction>(action_type);
+    // The ServiceAction is only allocated by the branches that emit one;
+    // the common CONTINUE_SERVICE case stays allocation-free
+    auto action_type = grant.get_action(credit_uc);
     switch (action_type) {
       case CONTINUE_SERVICE: {
         optional<CreditUsageUpdate> op_update =
@@ -1956,17 +2107,18 @@ void SessionState::get_charging_updates(
           // no update
           break;
         }
-        update_request_out->mutable_updates()->Add()->CopyFrom(*op_update);
+        *update_request_out->mutable_updates()->Add() = std::move(*op_update);
       } break;
       case REDIRECT: {
-        if (grant->service_state == SERVICE_REDIRECTED) {
+        if (grant.service_state == SERVICE_REDIRECTED) {
           MLOG(MDEBUG) << "Redirection already activated for " << session_id_;
           continue;
         }
-        grant->set_service_state(SERVICE_REDIRECTED, credit_uc);
+        grant.set_service_state(SERVICE_REDIRECTED, credit_uc);
 
-        PolicyRule redirect_rule = grant->make_redirect_rule();
+        PolicyRule redirect_rule = grant.make_redirect_rule();
         if (!is_gy_dynamic_rule_installed(redirect_rule.id())) {
+          auto action = std::make_unique<ServiceAction>(action_type);
           fill_service_action_for_redirect(
               action, key, grant, redirect_rule, session_uc);
           actions_out->push_back(std::move(action));
@@ -1975,25 +2127,30 @@ void SessionState::get_charging_updates(
         break;
       }
       case RESTRICT_ACCESS: {
-        if (grant->service_state == SERVICE_RESTRICTED) {
+        if (grant.service_state == SERVICE_RESTRICTED) {
           MLOG(MDEBUG) << "Restriction already activated for " << session_id_;
           continue;
         }
-        grant->set_service_state(SERVICE_RESTRICTED, credit_uc);
+        grant.set_service_state(SERVICE_RESTRICTED, credit_uc);
 
+        auto action = std::make_unique<ServiceAction>(action_type);
         fill_service_action_for_restrict(action, key, grant, session_uc);
         actions_out->push_back(std::move(action));
         break;
       }
-      case ACTIVATE_SERVICE:
+      case ACTIVATE_SERVICE: {
+        auto action = std::make_unique<ServiceAction>(action_type);
         fill_service_action_for_activate(action, key, session_uc);
         actions_out->push_back(std::move(action));
-        grant->set_suspended(false, credit_uc);
+        grant.set_suspended(false, credit_uc);
         break;
-      case TERMINATE_SERVICE:
+      }
+      case TERMINATE_SERVICE: {
+        auto action = std::make_unique<ServiceAction>(action_type);
         fill_service_action_with_context(action, action_type, key);
         actions_out->push_back(std::move(action));
         break;
+      }
       default:
         MLOG(MWARNING) << "Unexpected action type "
                        << service_action_type_to_str(action_type) << " for "
@@ -2004,10 +2161,10 @@ void SessionState::get_charging_updates(
 }
 
 optional<CreditUsageUpdate> SessionState::get_update_for_continue_service(
-    const CreditKey& key, std::unique_ptr<ChargingGrant>& grant,
+    const CreditKey& key, ChargingGrant& grant,
     SessionStateUpdateCriteria* session_uc) {
   CreditUsage::UpdateType update_type;
-  if (!grant->get_update_type(&update_type)) {
+  if (!grant.get_update_type(&update_type)) {
     return {};  // no update
   }
   if (curr_state_ == SESSION_RELEASED) {
@@ -2017,7 +2174,7 @@ optional<CreditUsageUpdate> SessionState::get_update_for_continue_service(
                  << key;
     return {};  // no update
   }
-  if (grant->suspended && update_type == CreditUsage::QUOTA_EXHAUSTED) {
+  if (grant.suspended && update_type == CreditUsage::QUOTA_EXHAUSTED) {
     MLOG(MDEBUG) << "Credit " << key << " for " << session_id_
                  << " is suspended. Not sending update to the core";
     return {};  // no update
@@ -2029,11 +2186,11 @@ optional<CreditUsageUpdate> SessionState::get_update_for_continue_service(
                << credit_update_type_to_str(update_type)
                << " with request number " << request_number_;
 
-  SessionCreditUpdateCriteria* credit_uc = get_credit_uc(key, session_uc);
+  SessionCreditUpdateCriteria* credit_uc = get_credit_uc(key, grant, session_uc);
   if (update_type == CreditUsage::REAUTH_REQUIRED) {
-    grant->set_reauth_state(REAUTH_PROCESSING, credit_uc);
+    grant.set_reauth_state(REAUTH_PROCESSING, credit_uc);
   }
-  CreditUsage usage = grant->get_credit_usage(update_type, credit_uc, false);
+  CreditUsage usage = grant.get_credit_usage(update_type, credit_uc, false);
   key.set_credit_usage(&usage);
 
   auto request = make_credit_usage_update_req(usage);
@@ -2066,12 +2223,11 @@ void SessionState::fill_service_action_for_activate(
 
 void SessionState::fill_service_action_for_restrict(
     std::unique_ptr<ServiceAction>& action_p, const CreditKey& key,
-    std::unique_ptr<ChargingGrant>& grant,
-    SessionStateUpdateCriteria* session_uc) {
+    ChargingGrant& grant, SessionStateUpdateCriteria* session_uc) {
   fill_service_action_with_context(action_p, RESTRICT_ACCESS, key);
 
   RulesToProcess* gy_to_install = action_p->get_mutable_gy_rules_to_install();
-  for (auto& rule_id : grant->final_action_info.restrict_rules) {
+  for (auto& rule_id : grant.final_action_info.restrict_rules) {
     PolicyRule rule;
     if (!static_rules_.get_rule(rule_id, &rule)) {
       MLOG(MWARNING) << "Static rule " << rule_id
@@ -2085,7 +2241,7 @@ void SessionState::fill_service_action_for_restrict(
 
 void SessionState::fill_service_action_for_redirect(
     std::unique_ptr<ServiceAction>& action_p, const CreditKey& key,
-    std::unique_ptr<ChargingGrant>& grant, PolicyRule redirect_rule,
+    ChargingGrant& grant, PolicyRule redirect_rule,
     SessionStateUpdateCriteria* session_uc) {
   fill_service_action_with_context(action_p, REDIRECT, key);
 
@@ -2099,13 +2255,14 @@ void SessionState::fill_service_action_with_context(
     const CreditKey& key) {
   MLOG(MDEBUG) << "Subscriber " << get_imsi() << " rating group " << key
                << " action type " << service_action_type_to_str(action_type);
+  const auto& common = config_.common_context;
   action->set_credit_key(key);
   action->set_imsi(get_imsi());
   action->set_ambr(config_.get_apn_ambr());
-  action->set_ip_addr(config_.common_context.ue_ipv4());
-  action->set_ipv6_addr(config_.common_context.ue_ipv6());
-  action->set_teids(config_.common_context.teids());
-  action->set_msisdn(config_.common_context.msisdn());
+  action->set_ip_addr(common.ue_ipv4());
+  action->set_ipv6_addr(common.ue_ipv6());
+  action->set_teids(common.teids());
+  action->set_msisdn(common.msisdn());
   action->set_session_id(session_id_);
 }
 
@@ -2125,27 +2282,29 @@ bool SessionState::receive_monitor(
       update.credit().level() == MonitoringLevel::SESSION_LEVEL) {
     update_session_level_key(update, session_uc);
   }
-  auto mkey = update.credit().monitoring_key();
-  auto it   = monitor_map_.find(mkey);
-
-  if (session_uc &&
-      session_uc->monitor_credit_map.find(mkey) !=
-          session_uc->monitor_credit_map.end() &&
-      session_uc->monitor_credit_map[mkey].deleted) {
-    // This will only happen if the PCRF responds back with more credit when
-    // the monitor has already been set to be terminated
-    MLOG(MDEBUG) << session_id_ << "Ignoring  update for monitor " << mkey
-                 << " because it has been set for deletion";
-    return false;
+  const std::string& mkey = update.credit().monitoring_key();
+  auto it                 = monitor_map_.find(mkey);
+
+  if (session_uc) {
+    auto uc_it = session_uc->monitor_credit_map.find(mkey);
+    if (uc_it != session_uc->monitor_credit_map.end() &&
+        uc_it->second.deleted) {
+      // This will only happen if the PCRF responds back with more credit when
+      // the monitor has already been set to be terminated
+      MLOG(MDEBUG) << session_id_ << "Ignoring  update for monitor " << mkey
+                   << " because it has been set for deletion";
+      return false;
+    }
   }
 
   if (it == monitor_map_.end()) {
     // new credit
     return init_new_monitor(update, session_uc);
   }
-  auto credit_uc = get_monitor_uc(mkey, session_uc);
+  // reuse the entry found above instead of hashing the key a second time
+  auto credit_uc = get_monitor_uc(mkey, it->second, session_uc);
   if (!update.success()) {
-    it->second->credit.mark_failure(update.result_code(), credit_uc);
+    it->second.credit.mark_failure(update.result_code(), credit_uc);
     return false;
   }
 
@@ -2162,12 +2321,12 @@ bool SessionState::receive_monitor(
     MLOG(MINFO) << session_id_ << " Received Disabled action for monitor "
                 << mkey << ". Will remove monitor after update is sent";
     // seting last update will deleted monitor after the update is sent.
-    it->second->credit.set_report_last_credit(true, credit_uc);
+    it->second.credit.set_report_last_credit(true, credit_uc);
 
   } else {
     MLOG(MINFO) << session_id_ << " Received monitor credit for " << mkey;
     const auto& gsu = update.credit().granted_units();
-    it->second->credit.receive_credit(gsu, credit_uc);
+    it->second.credit.receive_credit(gsu, credit_uc);
   }
 
   return true;
@@ -2182,18 +2341,18 @@ void SessionState::apply_monitor_updates(
 
   // Actual deletion of monitor
   if (credit_uc.deleted) {
-    if (it->second->level == MonitoringLevel::SESSION_LEVEL) {
+    if (it->second.level == MonitoringLevel::SESSION_LEVEL) {
       // session level change
       MLOG(MINFO) << "Removing Session Level monitor " << key;
       session_level_key_ = "";
     }
     MLOG(MINFO) << session_id_ << " Erasing monitor " << key;
-    monitor_map_.erase(key);
+    monitor_map_.erase(it);
     return;
   }
 
   auto& charging_grant = it->second;
-  auto& credit         = charging_grant->credit;
+  auto& credit         = charging_grant.credit;
 
   // Credit merging
   credit.apply_update_criteria(credit_uc);
@@ -2205,7 +2364,7 @@ uint64_t SessionState::get_monitor(
   if (it == monitor_map_.end()) {
     return 0;
   }
-  return it->second->credit.get_credit(bucket);
+  return it->second.credit.get_credit(bucket);
 }
 
 bool SessionState::set_monitor_reporting(
@@ -2217,7 +2376,7 @@ bool SessionState::set_monitor_reporting(
     return false;
   }
 
-  it->second->credit.set_reporting(reporting);
+  it->second.credit.set_reporting(reporting);
 
   if (session_uc != nullptr) {
     auto mon_credit_uc       = get_monitor_uc(key, session_uc);
@@ -2236,15 +2395,15 @@ bool SessionState::add_to_monitor(
     return false;
   }
 
-  auto credit_uc = get_monitor_uc(key, session_uc);
+  auto credit_uc = get_monitor_uc(key, it->second, session_uc);
 
-  it->second->credit.add_used_credit(used_tx, used_rx, credit_uc);
+  it->second.credit.add_used_credit(used_tx, used_rx, credit_uc);
 
   // after adding usage we check if monitor is exhausted
-  if (it->second->should_delete_monitor()) {
+  if (it->second.should_delete_monitor()) {
     MLOG(MINFO) << "Quota exhausted for monitor " << key
                 << ". Will remove monitor after update is sent";
-    it->second->credit.set_report_last_credit(true, credit_uc);
+    it->second.credit.set_report_last_credit(true, credit_uc);
   }
   return true;
 }
@@ -2255,7 +2414,7 @@ void SessionState::set_monitor(
   if (session_uc) {
     session_uc->monitor_credit_to_install[key] = monitor.marshal();
   }
-  monitor_map_[key] = std::make_unique<Monitor>(monitor);
+  monitor_map_[key] = std::move(monitor);
 }
 
 bool SessionState::init_new_monitor(
@@ -2272,20 +2431,20 @@ bool SessionState::init_new_monitor(
                    << update.credit().monitoring_key();
     return false;
   }
+  const std::string& mkey = update.credit().monitoring_key();
   MLOG(MDEBUG) << session_id_ << " Initialized a monitoring credit for mkey "
-               << update.credit().monitoring_key();
-  auto monitor   = std::make_unique<Monitor>();
-  monitor->level = update.credit().level();
+               << mkey;
+  Monitor monitor;
+  monitor.level = update.credit().level();
   // validity time and final units not used for monitors
   auto _   = SessionCreditUpdateCriteria{};
   auto gsu = update.credit().granted_units();
-  monitor->credit.receive_credit(gsu, nullptr);
+  monitor.credit.receive_credit(gsu, nullptr);
 
   if (session_uc) {
-    session_uc->monitor_credit_to_install[update.credit().monitoring_key()] =
-        monitor->marshal();
+    session_uc->monitor_credit_to_install[mkey] = monitor.marshal();
   }
-  monitor_map_[update.credit().monitoring_key()] = std::move(monitor);
+  monitor_map_[mkey] = std::move(monitor);
   return true;
 }
 
@@ -2293,7 +2452,7 @@ void SessionState::update_session_level_key(
     const UsageMonitoringUpdateResponse& update,
     SessionStateUpdateCriteria* session_uc) {
   const auto& new_key = update.credit().monitoring_key();
-  if (session_level_key_ != "" && session_level_key_ != new_key) {
+  if (!session_level_key_.empty() && session_level_key_ != new_key) {
     MLOG(MINFO) << "Session level monitoring key is updated from "
                 << session_level_key_ << " to " << new_key;
   }
@@ -2319,6 +2478,16 @@ BearerUpdate SessionState::get_dedicated_bearer_updates(
     const RulesToProcess& pending_deactivation,
     SessionStateUpdateCriteria* session_uc) {
   BearerUpdate update;
+  // Size the repeated fields for the whole batch up front; this only grows
+  // the pointer arrays, and each list contributes at most one entry per rule
+  if (!pending_activation.empty()) {
+    update.create_req.mutable_policy_rules()->Reserve(
+        pending_activation.size());
+  }
+  if (!pending_deactivation.empty()) {
+    update.delete_req.mutable_eps_bearer_ids()->Reserve(
+        pending_deactivation.size());
+  }
   // Rule Installs
   for (const auto& to_process : pending_activation) {
     const auto& rule_id = to_process.rule.id();
@@ -2359,12 +2528,13 @@ void SessionState::bind_policy_to_bearer(
   MLOG(MINFO) << session_id_ << " now has policy " << rule_id
               << " tied to bearerID " << request.bearer_id();
   BearerIDAndTeid brearer_id_and_teid;
-  brearer_id_and_teid.bearer_id                         = request.bearer_id();
-  brearer_id_and_teid.teids                             = request.teids();
-  bearer_id_by_policy_[PolicyID(*policy_type, rule_id)] = brearer_id_and_teid;
+  brearer_id_and_teid.bearer_id   = request.bearer_id();
+  brearer_id_and_teid.teids       = request.teids();
+  PolicyID policy_id              = PolicyID(*policy_type, rule_id);
+  bearer_id_by_policy_[policy_id] = brearer_id_and_teid;
   if (session_uc) {
     session_uc->is_bearer_mapping_updated = true;
-    session_uc->bearer_id_by_policy       = bearer_id_by_policy_;
+    session_uc->bearer_id_by_policy_added[policy_id] = brearer_id_and_teid;
   }
 }
 
@@ -2399,12 +2569,27 @@ SessionCreditUpdateCriteria* SessionState::get_monitor_uc(
   if (!session_uc) {
     return nullptr;
   }
-  if (session_uc->monitor_credit_map.find(key) ==
-      session_uc->monitor_credit_map.end()) {
-    session_uc->monitor_credit_map[key] =
-        monitor_map_[key]->credit.get_update_criteria();
+  // Same single-probe pattern as get_credit_uc
+  const size_t size_before          = session_uc->monitor_credit_map.size();
+  SessionCreditUpdateCriteria& slot = session_uc->monitor_credit_map[key];
+  if (session_uc->monitor_credit_map.size() != size_before) {
+    slot = monitor_map_[key].credit.get_update_criteria();
+  }
+  return &slot;
+}
+
+SessionCreditUpdateCriteria* SessionState::get_monitor_uc(
+    const std::string& key, Monitor& monitor,
+    SessionStateUpdateCriteria* session_uc) {
+  if (!session_uc) {
+    return nullptr;
+  }
+  const size_t size_before          = session_uc->monitor_credit_map.size();
+  SessionCreditUpdateCriteria& slot = session_uc->monitor_credit_map[key];
+  if (session_uc->monitor_credit_map.size() != size_before) {
+    slot = monitor.credit.get_update_criteria();
   }
-  return &(session_uc->monitor_credit_map[key]);
+  return &slot;
 }
 
 // Event Triggers
@@ -2412,8 +2597,7 @@ void SessionState::get_event_trigger_updates(
     UpdateSessionRequest* update_request_out,
     SessionStateUpdateCriteria* session_uc) {
   // todo We should also handle other event triggers here too
-  auto it = pending_event_triggers_.find(REVALIDATION_TIMEOUT);
-  if (it != pending_event_triggers_.end() && it->second == READY) {
+  if (needs_revalidation_update()) {
     MLOG(MDEBUG) << "Session " << session_id_
                  << " updating due to EventTrigger: REVALIDATION_TIMEOUT"
                  << " with request number " << request_number_;
@@ -2439,9 +2623,8 @@ void SessionState::add_new_event_trigger(
 
 void SessionState::mark_event_trigger_as_triggered(
     magma::lte::EventTrigger trigger, SessionStateUpdateCriteria* session_uc) {
-  auto it = pending_event_triggers_.find(trigger);
-  if (it == pending_event_triggers_.end() ||
-      pending_event_triggers_[trigger] != PENDING) {
+  if (!pending_event_triggers_present_.test(trigger) ||
+      pending_event_triggers_state_[trigger] != PENDING) {
     MLOG(MWARNING) << "Event Trigger " << trigger << " requested to be "
                    << "triggered is not pending for " << session_id_;
   }
@@ -2454,20 +2637,33 @@ void SessionState::remove_event_trigger(
     magma::lte::EventTrigger trigger, SessionStateUpdateCriteria* session_uc) {
   MLOG(MINFO) << "Event Trigger " << trigger << " is removed for "
               << session_id_;
-  pending_event_triggers_.erase(trigger);
+  // matches the old map behavior: the entry is re-added as CLEARED below
+  pending_event_triggers_present_.reset(trigger);
   set_event_trigger(trigger, CLEARED, session_uc);
 }
 
 void SessionState::set_event_trigger(
     magma::lte::EventTrigger trigger, const EventTriggerState value,
     SessionStateUpdateCriteria* session_uc) {
-  pending_event_triggers_[trigger] = value;
+  pending_event_triggers_present_.set(trigger);
+  pending_event_triggers_state_[trigger] = value;
   if (session_uc) {
     session_uc->is_pending_event_triggers_updated = true;
     session_uc->pending_event_triggers[trigger]   = value;
   }
 }
 
+EventTriggerStatus SessionState::get_event_triggers() const {
+  EventTriggerStatus status;
+  for (size_t i = 0; i < pending_event_triggers_present_.size(); i++) {
+    if (pending_event_triggers_present_.test(i)) {
+      status[static_cast<magma::lte::EventTrigger>(i)] =
+          pending_event_triggers_state_[i];
+    }
+  }
+  return status;
+}
+
 void SessionState::set_revalidation_time(
     const google::protobuf::Timestamp& time,
     SessionStateUpdateCriteria* session_uc) {
@@ -2483,11 +2679,11 @@ optional<FinalActionInfo> SessionState::get_final_action_if_final_unit_state(
   if (it == credit_map_.end()) {
     return {};
   }
-  if (it->second->service_state != SERVICE_REDIRECTED &&
-      it->second->service_state != SERVICE_RESTRICTED) {
+  if (it->second.service_state != SERVICE_REDIRECTED &&
+      it->second.service_state != SERVICE_RESTRICTED) {
     return {};
   }
-  return it->second->final_action_info;
+  return it->second.final_action_info;
 }
 
 RulesToProcess SessionState::remove_all_final_action_rules(
@@ -2505,7 +2701,7 @@ RulesToProcess SessionState::remove_all_final_action_rules(
       }
     } break;
     case ChargingCredit_FinalAction_RESTRICT_ACCESS:
-      for (std::string rule_id : final_action_info.restrict_rules) {
+      for (const std::string& rule_id : final_action_info.restrict_rules) {
         PolicyRule rule;
         optional<RuleToProcess> op_rule_info =
             remove_gy_rule(rule_id, &rule, session_uc);
@@ -2524,15 +2720,17 @@ RulesToProcess SessionState::remove_all_final_action_rules(
 bool SessionState::policy_has_qos(
     const PolicyType policy_type, const std::string& rule_id,
     PolicyRule* rule_out) {
-  if (policy_type == STATIC) {
-    bool exists = static_rules_.get_rule(rule_id, rule_out);
-    return exists && rule_out->has_qos();
-  }
-  if (policy_type == DYNAMIC) {
-    bool exists = dynamic_rules_.get_rule(rule_id, rule_out);
-    return exists && rule_out->has_qos();
+  // pick the store for the policy type, then share the lookup + QoS check
+  PolicyRuleBiMap* store = nullptr;
+  switch (policy_type) {
+    case STATIC:
+      store = &static_rules_;
+      break;
+    case DYNAMIC:
+      store = &dynamic_rules_;
+      break;
   }
-  return false;
+  return store && store->get_rule(rule_id, rule_out) && rule_out->has_qos();
 }
 
 optional<PolicyRule> SessionState::policy_needs_bearer_creation(
@@ -2570,13 +2768,14 @@ void SessionState::update_bearer_creation_req(
   // If it is first time filling in the CreationReq, fill in other info
   if (!update->needs_creation) {
     update->needs_creation = true;
-    update->create_req.mutable_sid()->CopyFrom(config_.common_context.sid());
-    update->create_req.set_ip_addr(config_.common_context.ue_ipv4());
+    const auto& common     = config_.common_context;
+    update->create_req.mutable_sid()->CopyFrom(common.sid());
+    update->create_req.set_ip_addr(common.ue_ipv4());
     // TODO ipv6 add to the bearer request or remove ipv4
     update->create_req.set_link_bearer_id(
         config_.rat_specific_context.lte_context().bearer_id());
   }
-  update->create_req.mutable_policy_rules()->Add()->CopyFrom(*policy);
+  *update->create_req.mutable_policy_rules()->Add() = std::move(*policy);
   // We will add the new policyID to bearerID association, once we receive a
   // message from SGW.
 }
@@ -2587,46 +2786,60 @@ void SessionState::update_bearer_deletion_req(
   if (!config_.rat_specific_context.has_lte_context()) {
     return;
   }
-  if (bearer_id_by_policy_.find(PolicyID(policy_type, rule_id)) ==
-      bearer_id_by_policy_.end()) {
+  auto bearer_it = bearer_id_by_policy_.find(PolicyID(policy_type, rule_id));
+  if (bearer_it == bearer_id_by_policy_.end()) {
     return;
   }
   // map change needs to be propagated to the store
-  const BearerIDAndTeid bearer_id_to_delete =
-      bearer_id_by_policy_[PolicyID(policy_type, rule_id)];
-  bearer_id_by_policy_.erase(PolicyID(policy_type, rule_id));
+  const PolicyID policy_id                  = bearer_it->first;
+  const BearerIDAndTeid bearer_id_to_delete = bearer_it->second;
+  bearer_id_by_policy_.erase(bearer_it);
 
   if (session_uc) {
     session_uc->is_bearer_mapping_updated = true;
-    session_uc->bearer_id_by_policy       = bearer_id_by_policy_;
+    // drop any same-cycle add for this policy before recording the removal
+    session_uc->bearer_id_by_policy_added.erase(policy_id);
+    session_uc->bearer_id_by_policy_removed.push_back(policy_id);
   }
 
   // If it is first time filling in the DeletionReq, fill in other info
   if (!update->needs_deletion) {
     update->needs_deletion = true;
     auto& req              = update->delete_req;
-    req.mutable_sid()->CopyFrom(config_.common_context.sid());
-    req.set_ip_addr(config_.common_context.ue_ipv4());
+    const auto& common     = config_.common_context;
+    req.mutable_sid()->CopyFrom(common.sid());
+    req.set_ip_addr(common.ue_ipv4());
     // TODO ipv6 add to the bearer request or remove ipv4
     req.set_link_bearer_id(
         config_.rat_specific_context.lte_context().bearer_id());
   }
-  update->delete_req.mutable_eps_bearer_ids()->Add(
-      bearer_id_to_delete.bearer_id);
+  const uint32_t bearer_id = bearer_id_to_delete.bearer_id;
+  if (bearer_id < update->queued_delete_bearer_ids.size()) {
+    if (update->queued_delete_bearer_ids.test(bearer_id)) {
+      // another policy on the same bearer already queued this deletion
+      return;
+    }
+    update->queued_delete_bearer_ids.set(bearer_id);
+  }
+  update->delete_req.mutable_eps_bearer_ids()->Add(bearer_id);
 }
 
 std::vector<Teids> SessionState::get_active_teids() {
-  std::vector<Teids> teids = {config_.common_context.teids()};
-  for (auto bearer_pair : bearer_id_by_policy_) {
+  std::vector<Teids> teids;
+  teids.reserve(1 + bearer_id_by_policy_.size());
+  teids.push_back(config_.common_context.teids());
+  for (const auto& bearer_pair : bearer_id_by_policy_) {
     teids.push_back(bearer_pair.second.teids);
   }
   return teids;
 }
 
 RuleSetToApply::RuleSetToApply(const magma::lte::RuleSet& rule_set) {
+  static_rules.reserve(rule_set.static_rules_size());
   for (const auto& static_rule_install : rule_set.static_rules()) {
     static_rules.insert(static_rule_install.rule_id());
   }
+  dynamic_rules.reserve(rule_set.dynamic_rules_size());
   for (const auto& dynamic_rule_install : rule_set.dynamic_rules()) {
     dynamic_rules[dynamic_rule_install.policy_rule().id()] =
         dynamic_rule_install.policy_rule();
@@ -2634,9 +2847,11 @@ RuleSetToApply::RuleSetToApply(const magma::lte::RuleSet& rule_set) {
 }
 
 void RuleSetToApply::combine_rule_set(const RuleSetToApply& other) {
-  for (const auto& static_rule : other.static_rules) {
-    static_rules.insert(static_rule);
-  }
+  static_rules.reserve(static_rules.size() + other.static_rules.size());
+  static_rules.insert(other.static_rules.begin(), other.static_rules.end());
+  dynamic_rules.reserve(dynamic_rules.size() + other.dynamic_rules.size());
+  // keep the explicit loop: the combined set overwrites existing entries,
+  // which a ranged insert would skip
   for (const auto& dynamic_pair : other.dynamic_rules) {
     dynamic_rules[dynamic_pair.first] = dynamic_pair.second;
   }
@@ -2645,34 +2860,35 @@ void RuleSetToApply::combine_rule_set(const RuleSetToApply& other) {
 RuleSetBySubscriber::RuleSetBySubscriber(
     const RulesPerSubscriber& rules_per_subscriber) {
   imsi = rules_per_subscriber.imsi();
+  rule_set_by_apn.reserve(rules_per_subscriber.rule_set_size());
   for (const auto& rule_set : rules_per_subscriber.rule_set()) {
     if (rule_set.apply_subscriber_wide()) {
       subscriber_wide_rule_set = RuleSetToApply(rule_set);
     } else {
-      subscriber_wide_rule_set        = {};
+      // note: a per-APN entry must not clear a subscriber-wide set that
+      // appeared earlier in the list
       rule_set_by_apn[rule_set.apn()] = RuleSetToApply(rule_set);
     }
   }
 }
 
-optional<RuleSetToApply> RuleSetBySubscriber::get_combined_rule_set_for_apn(
-    const std::string& apn) {
-  const bool apn_rule_set_exists =
-      rule_set_by_apn.find(apn) != rule_set_by_apn.end();
+bool RuleSetBySubscriber::get_combined_rule_set_for_apn(
+    const std::string& apn, RuleSetToApply* rule_set_out) {
+  const auto apn_it = rule_set_by_apn.find(apn);
   // Apply subscriber wide rule set if it exists. Also apply per-APN rule
   // set if it exists.
-  if (apn_rule_set_exists && subscriber_wide_rule_set) {
-    auto rule_set_to_apply = rule_set_by_apn[apn];
-    rule_set_to_apply.combine_rule_set(*subscriber_wide_rule_set);
-    return rule_set_to_apply;
+  if (apn_it != rule_set_by_apn.end()) {
+    *rule_set_out = apn_it->second;
+    if (subscriber_wide_rule_set) {
+      rule_set_out->combine_rule_set(*subscriber_wide_rule_set);
+    }
+    return true;
   }
   if (subscriber_wide_rule_set) {
-    return subscriber_wide_rule_set;
-  }
-  if (apn_rule_set_exists) {
-    return rule_set_by_apn[apn];
+    *rule_set_out = *subscriber_wide_rule_set;
+    return true;
   }
-  return {};
+  return false;
 }
 
 void SessionState::set_data_metrics(
@@ -2691,12 +2907,10 @@ void SessionState::increment_data_metrics(
     const char* counter_name, uint64_t delta_tx, uint64_t delta_rx) const {
   const char* imsi = config_.common_context.sid().id().c_str();
   const char* apn  = config_.common_context.apn().c_str();
-  increment_counter(
-      counter_name, delta_tx, size_t(3), LABEL_IMSI, imsi, LABEL_APN, apn,
-      LABEL_DIRECTION, DIRECTION_UP);
-  increment_counter(
-      counter_name, delta_rx, size_t(3), LABEL_IMSI, imsi, LABEL_APN, apn,
-      LABEL_DIRECTION, DIRECTION_DOWN);
+  // one helper call parses the shared labels once for both directions
+  magma::service303::increment_counter_pair(
+      counter_name, LABEL_DIRECTION, DIRECTION_UP, delta_tx, DIRECTION_DOWN,
+      delta_rx, size_t(2), LABEL_IMSI, imsi, LABEL_APN, apn);
 }
 
 void SessionState::clear_session_metrics() const {
@@ -13,9 +13,13 @@
 #pragma once
 
 #include <experimental/optional>
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 #include <lte/protos/spgw_service.grpc.pb.h>
 
+#include <array>
+#include <bitset>
 #include <functional>
 #include <memory>
 #include <set>
@@ -36,19 +40,25 @@
 
 namespace magma {
 using std::experimental::optional;
-typedef std::unordered_map<
-    CreditKey, std::unique_ptr<ChargingGrant>, decltype(&ccHash),
-    decltype(&ccEqual)>
+// Credit and monitor lookups run once per usage record, so both maps use
+// folly's open-addressing F14 layout to avoid std::unordered_map's bucket
+// pointer chasing. The node-based variant stores grants and monitors as
+// plain values while keeping their addresses stable across rehashing, which
+// callers rely on, without the extra unique_ptr hop.
+typedef folly::F14NodeMap<
+    CreditKey, ChargingGrant, decltype(&ccHash), decltype(&ccEqual)>
     CreditMap;
-typedef std::unordered_map<
+typedef folly::F14FastMap<
     CreditKey, SessionCredit::Summary, decltype(&ccHash), decltype(&ccEqual)>
     ChargingCreditSummaries;
-typedef std::unordered_map<std::string, std::unique_ptr<Monitor>> MonitorMap;
+typedef folly::F14NodeMap<std::string, Monitor> MonitorMap;
 
 // Used to transform the proto message RuleSet into a more useful structure
 struct RuleSetToApply {
-  std::unordered_map<std::string, PolicyRule> dynamic_rules;
-  std::unordered_set<std::string> static_rules;
+  // node-based variant keeps the large PolicyRule values out of the probe
+  // array, mirroring the credit/monitor map choice
+  folly::F14NodeMap<std::string, PolicyRule> dynamic_rules;
+  folly::F14FastSet<std::string> static_rules;
 
   RuleSetToApply() {}
   RuleSetToApply(const magma::lte::RuleSet& rule_set);
@@ -68,8 +78,13 @@ struct RuleSetBySubscriber {
   optional<RuleSetToApply> subscriber_wide_rule_set;
 
   RuleSetBySubscriber(const RulesPerSubscriber& rules_per_subscriber);
-  optional<RuleSetToApply> get_combined_rule_set_for_apn(
-      const std::string& apn);
+  /**
+   * Fill rule_set_out with the rule set for the APN, merged with the
+   * subscriber-wide rule set when both exist. One map probe per call.
+   * @return false if neither a per-APN nor a subscriber-wide set exists
+   */
+  bool get_combined_rule_set_for_apn(
+      const std::string& apn, RuleSetToApply* rule_set_out);
 };
 
 struct BearerUpdate {
@@ -77,6 +92,10 @@ struct BearerUpdate {
   CreateBearerRequest create_req;  // only valid if needs_creation is true
   bool needs_deletion;
   DeleteBearerRequest delete_req;  // only valid if needs_deletion is true
+  // Bearer IDs already queued in delete_req; several policies can share one
+  // bearer, and the SGW request should carry each ID once. EPS bearer IDs
+  // are tiny in practice, so a fixed bitset dedupes without allocating.
+  std::bitset<256> queued_delete_bearer_ids;
   BearerUpdate() : needs_creation(false), needs_deletion(false) {}
 };
 
@@ -138,14 +157,24 @@ class SessionState {
       const magma::lte::TgppContext& tgpp_context, uint64_t pdp_start_time,
       const CreateSessionResponse& csr);
 
-  SessionState(
-      const StoredSessionState& marshaled, StaticRuleStore& rule_store);
+  // Takes the StoredSessionState by value so rvalue callers (e.g. the Redis
+  // deserializer) move straight into the members; lvalue callers pay one
+  // aggregate copy at the call site instead of a copy per field
+  SessionState(StoredSessionState marshaled, StaticRuleStore& rule_store);
 
   static std::unique_ptr<SessionState> unmarshal(
-      const StoredSessionState& marshaled, StaticRuleStore& rule_store);
+      StoredSessionState marshaled, StaticRuleStore& rule_store);
 
   StoredSessionState marshal();
 
+  /**
+   * marshal_move is a destructive variant of marshal for SessionStates that
+   * are about to be discarded (e.g. when a SessionMap is written back to the
+   * store): heavyweight members are moved into the StoredSessionState instead
+   * of being copied. The SessionState is left in an unspecified state.
+   */
+  StoredSessionState marshal_move() &&;
+
   // 5G processing constructor without response contxt as set-interface msg
   SessionState(
       const std::string& imsi, const std::string& session_ctx_id,
@@ -294,7 +323,7 @@ class SessionState {
 
   void set_config(const SessionConfig& config);
 
-  SessionConfig get_config() const { return config_; }
+  const SessionConfig& get_config() const { return config_; }
 
   void set_subscriber_quota_state(
       const magma::lte::SubscriberQuotaUpdate_Type state,
@@ -434,9 +463,9 @@ class SessionState {
 
   bool deactivate_scheduled_static_rule(const std::string& rule_id);
 
-  std::vector<std::string>& get_static_rules();
+  const std::vector<std::string>& get_static_rules() const;
 
-  std::set<std::string>& get_scheduled_static_rules();
+  const folly::F14FastSet<std::string>& get_scheduled_static_rules() const;
 
   DynamicRuleStore& get_dynamic_rules();
 
@@ -468,7 +497,12 @@ class SessionState {
 
   bool is_credit_ready_to_be_activated(const CreditKey& charging_key);
 
-  RuleLifetime& get_rule_lifetime(const std::string& rule_id);
+  /**
+   * Look up the lifetime tracked for the given rule. Returns a
+   * default-constructed (always-active) lifetime when none is tracked;
+   * never inserts into the lifetime map.
+   */
+  RuleLifetime get_rule_lifetime(const std::string& rule_id) const;
 
   DynamicRuleStore& get_gy_dynamic_rules();
 
@@ -524,7 +558,22 @@ class SessionState {
     return revalidation_time_;
   }
 
-  EventTriggerStatus get_event_triggers() { return pending_event_triggers_; }
+  /**
+   * Build the map-shaped view of the pending event triggers. The triggers
+   * are stored in a flat array internally, so this copies them out; use the
+   * trigger-specific helpers on hot paths.
+   */
+  EventTriggerStatus get_event_triggers() const;
+
+  /**
+   * True when a REVALIDATION_TIMEOUT trigger is ready to be reported.
+   * Runs on every session update cycle, so it is a single bit test plus
+   * one state compare against the flat trigger array.
+   */
+  bool needs_revalidation_update() const {
+    return pending_event_triggers_present_.test(REVALIDATION_TIMEOUT) &&
+           pending_event_triggers_state_[REVALIDATION_TIMEOUT] == READY;
+  }
 
   optional<FinalActionInfo> get_final_action_if_final_unit_state(
       const CreditKey& ckey) const;
@@ -625,9 +674,18 @@ class SessionState {
       CreditKey ckey, SessionStateUpdateCriteria* session_uc);
 
   /**
-   * Returns true if the specified rule should be active at that time
+   * Returns true if a rule with the given lifetime should be active at that
+   * time
+   */
+  static bool should_rule_be_active(
+      const RuleLifetime& lifetime, std::time_t time);
+
+  /**
+   * Convenience overload looking the lifetime up by rule ID. A rule without a
+   * tracked lifetime is treated as always active; no entry is inserted.
    */
-  bool should_rule_be_active(const std::string& rule_id, std::time_t time);
+  bool should_rule_be_active(
+      const std::string& rule_id, std::time_t time) const;
   bool is_dynamic_rule_scheduled(const std::string& rule_id);
 
   /**
@@ -648,8 +706,10 @@ class SessionState {
    * @param session_uc
    */
   void process_rules_to_install(
-      const std::vector<StaticRuleInstall>& static_rule_installs,
-      const std::vector<DynamicRuleInstall>& dynamic_rule_installs,
+      const google::protobuf::RepeatedPtrField<StaticRuleInstall>&
+          static_rule_installs,
+      const google::protobuf::RepeatedPtrField<DynamicRuleInstall>&
+          dynamic_rule_installs,
       RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
       RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
       SessionStateUpdateCriteria* session_uc);
@@ -668,7 +728,8 @@ class SessionState {
    * @param session_uc
    */
   void process_static_rule_installs(
-      const std::vector<StaticRuleInstall>& rule_installs,
+      const google::protobuf::RepeatedPtrField<StaticRuleInstall>&
+          rule_installs,
       RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
       RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
       SessionStateUpdateCriteria* session_uc);
@@ -687,7 +748,8 @@ class SessionState {
    * @param session_uc
    */
   void process_dynamic_rule_installs(
-      const std::vector<DynamicRuleInstall>& rule_installs,
+      const google::protobuf::RepeatedPtrField<DynamicRuleInstall>&
+          rule_installs,
       RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
       RulesToProcess* pending_bearer_setup, RulesToSchedule* pending_scheduling,
       SessionStateUpdateCriteria* session_uc);
@@ -701,7 +763,7 @@ class SessionState {
    * @param session_uc
    */
   void process_rules_to_remove(
-      const google::protobuf::RepeatedPtrField<std::basic_string<char>>
+      const google::protobuf::RepeatedPtrField<std::basic_string<char>>&
           rules_to_remove,
       RulesToProcess* pending_deactivation,
       SessionStateUpdateCriteria* session_uc);
@@ -754,6 +816,12 @@ class SessionState {
   // Used between create session and activate session. Empty afterwards
   CreateSessionResponse create_session_response_;
 
+  // Prebuilt CreditUsageUpdate carrying the session/config fields that are
+  // stable between config changes; make_credit_usage_update_req copies this
+  // once per update instead of refilling every field. Rebuilt whenever
+  // config_ or tgpp_context_ change.
+  CreditUsageUpdate credit_update_template_;
+
   // Track version tracking information used for LTE/WLAN
   PolicyStatsMap policy_version_and_stats_;
 
@@ -761,23 +829,31 @@ class SessionState {
   StaticRuleStore& static_rules_;
   // Static rules that are currently installed for the session
   std::vector<std::string> active_static_rules_;
+  // Mirrors active_static_rules_ for O(1) membership checks;
+  // is_static_rule_installed runs inside every rule-set diff and install
+  // loop. The vector is kept for marshaling and ordered iteration.
+  folly::F14FastSet<std::string> active_static_rules_set_;
   // Dynamic GX rules that are currently installed for the session
   DynamicRuleStore dynamic_rules_;
   // Dynamic GY rules that are currently installed for the session
   DynamicRuleStore gy_dynamic_rules_;
 
   // Static rules that are scheduled for installation for the session
-  std::set<std::string> scheduled_static_rules_;
+  folly::F14FastSet<std::string> scheduled_static_rules_;
   // Dynamic rules that are scheduled for installation for the session
   DynamicRuleStore scheduled_dynamic_rules_;
   // Activation & deactivation times for each rule that is either currently
   // installed, or scheduled for installation for this session
-  std::unordered_map<std::string, RuleLifetime> rule_lifetimes_;
+  RuleLifetimeMap rule_lifetimes_;
 
-  // map of Gx event_triggers that are pending and its status (bool)
-  // If the value is true, that means an update request for that event trigger
+  // Gx event_triggers that are pending and their status, indexed directly by
+  // the EventTrigger enum value: the enum is small and dense, so a flat
+  // array plus a present-bitset replaces the hash map the marshaled state
+  // still uses. A READY state means an update request for that event trigger
   // should be sent
-  EventTriggerStatus pending_event_triggers_;
+  std::array<EventTriggerState, EventTrigger_ARRAYSIZE>
+      pending_event_triggers_state_{};
+  std::bitset<EventTrigger_ARRAYSIZE> pending_event_triggers_present_;
   // todo for stateless we will have to store a bit more information so we can
   // reschedule triggers
   google::protobuf::Timestamp revalidation_time_;
@@ -816,7 +892,7 @@ class SessionState {
    * @return optional<CreditUsageUpdate>
    */
   optional<CreditUsageUpdate> get_update_for_continue_service(
-      const CreditKey& key, std::unique_ptr<ChargingGrant>& grant,
+      const CreditKey& key, ChargingGrant& grant,
       SessionStateUpdateCriteria* session_uc);
 
   void fill_service_action_for_activate(
@@ -825,12 +901,11 @@ class SessionState {
 
   void fill_service_action_for_restrict(
       std::unique_ptr<ServiceAction>& action_p, const CreditKey& key,
-      std::unique_ptr<ChargingGrant>& grant,
-      SessionStateUpdateCriteria* session_uc);
+      ChargingGrant& grant, SessionStateUpdateCriteria* session_uc);
 
   void fill_service_action_for_redirect(
       std::unique_ptr<ServiceAction>& action_p, const CreditKey& key,
-      std::unique_ptr<ChargingGrant>& grant, PolicyRule redirect_rule,
+      ChargingGrant& grant, PolicyRule redirect_rule,
       SessionStateUpdateCriteria* session_uc);
 
   void fill_service_action_with_context(
@@ -853,10 +928,6 @@ class SessionState {
       const CreditUpdateResponse& update,
       SessionStateUpdateCriteria* session_uc);
 
-  /**
-   * Return true if any credit unit is valid and has non-zero volume
-   */
-  bool contains_credit(const GrantedUnits& gsu);
 
   /**
    * For this session, add the UsageMonitoringUpdateRequest to the
@@ -881,15 +952,27 @@ class SessionState {
       UsageMonitoringUpdateRequest* req);
 
   /**
-   * Returns true if the specified rule should be deactivated by that time
+   * Returns true if a rule with the given lifetime should be deactivated by
+   * that time
    */
-  bool should_rule_be_deactivated(const std::string& rule_id, std::time_t time);
+  static bool should_rule_be_deactivated(
+      const RuleLifetime& lifetime, std::time_t time);
 
   SessionCreditUpdateCriteria* get_credit_uc(
       const CreditKey& key, SessionStateUpdateCriteria* session_uc);
 
+  /**
+   * Overload for callers that already hold the ChargingGrant for the key;
+   * avoids re-hashing the key into credit_map_ on the usage reporting path.
+   */
+  SessionCreditUpdateCriteria* get_credit_uc(
+      const CreditKey& key, ChargingGrant& grant,
+      SessionStateUpdateCriteria* session_uc);
+
   CreditUsageUpdate make_credit_usage_update_req(CreditUsage& usage) const;
 
+  void rebuild_credit_update_template();
+
   bool init_new_monitor(
       const UsageMonitoringUpdateResponse& update,
       SessionStateUpdateCriteria* session_uc);
@@ -901,6 +984,14 @@ class SessionState {
   SessionCreditUpdateCriteria* get_monitor_uc(
       const std::string& key, SessionStateUpdateCriteria* session_uc);
 
+  /**
+   * Overload for callers that already hold the Monitor for the key; avoids
+   * re-hashing the key into monitor_map_ on the usage reporting path.
+   */
+  SessionCreditUpdateCriteria* get_monitor_uc(
+      const std::string& key, Monitor& monitor,
+      SessionStateUpdateCriteria* session_uc);
+
   void fill_protos_tgpp_context(magma::lte::TgppContext* tgpp_context) const;
 
   void get_event_trigger_updates(
@@ -909,14 +1000,14 @@ class SessionState {
 
   /** apply static_rules which is the desired state for the session's rules **/
   void apply_session_static_rule_set(
-      const std::unordered_set<std::string> static_rules,
+      const std::unordered_set<std::string>& static_rules,
       RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
       RulesToProcess* pending_bearer_setup,
       SessionStateUpdateCriteria* session_uc);
 
   /** apply dynamic_rules which is the desired state for the session's rules **/
   void apply_session_dynamic_rule_set(
-      const std::unordered_map<std::string, PolicyRule> dynamic_rules,
+      const std::unordered_map<std::string, PolicyRule>& dynamic_rules,
       RulesToProcess* pending_activation, RulesToProcess* pending_deactivation,
       RulesToProcess* pending_bearer_setup,
       SessionStateUpdateCriteria* session_uc);
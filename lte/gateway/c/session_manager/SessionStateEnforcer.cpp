@@ -112,7 +112,7 @@ bool SessionStateEnforcer::m5g_init_session_credit(
   auto exist_imsi = session_map.find(imsi);
   if (exist_imsi == session_map.end()) {
     // First time a session is created for IMSI in the SessionMap
-    session_map[imsi] = std::vector<std::unique_ptr<SessionState>>();
+    session_map[imsi] = SessionVector();
   } else {
     session_map[imsi].push_back(std::move(session_state));
   }
@@ -12,12 +12,13 @@
  */
 #pragma once
 
+#include <folly/container/F14Map.h>
+#include <folly/small_vector.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 
 #include <memory>
 #include <set>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "SessionState.h"
@@ -25,8 +26,13 @@
 namespace magma {
 namespace lte {
 
-using SessionVector = std::vector<std::unique_ptr<SessionState>>;
-using SessionMap    = std::unordered_map<std::string, SessionVector>;
+// Most IMSIs carry exactly one session, so keep the first entry inline and
+// only spill to the heap for multi-APN subscribers
+using SessionVector = folly::small_vector<std::unique_ptr<SessionState>, 1>;
+// IMSI-keyed lookups dominate the per-report aggregation path, so use an
+// open-addressing map to avoid the per-node allocations and pointer-chasing
+// of std::unordered_map
+using SessionMap = folly::F14FastMap<std::string, SessionVector>;
 
 /**
  * StoreClient is responsible for reading/writing sessions to/from storage.
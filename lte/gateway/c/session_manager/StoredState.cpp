@@ -649,22 +649,22 @@ RuleLifetime::RuleLifetime(const DynamicRuleInstall& rule_install) {
       TimeUtil::TimestampToSeconds(rule_install.deactivation_time()));
 }
 
-bool RuleLifetime::is_within_lifetime(std::time_t time) {
+bool RuleLifetime::is_within_lifetime(std::time_t time) const {
   auto past_activation_time = activation_time <= time;
   auto before_deactivation_time =
       (deactivation_time == 0) || (time < deactivation_time);
   return past_activation_time && before_deactivation_time;
 }
 
-bool RuleLifetime::exceeded_lifetime(std::time_t time) {
+bool RuleLifetime::exceeded_lifetime(std::time_t time) const {
   return deactivation_time != 0 && deactivation_time <= time;
 }
 
-bool RuleLifetime::before_lifetime(std::time_t time) {
+bool RuleLifetime::before_lifetime(std::time_t time) const {
   return time < activation_time;
 }
 
-bool RuleLifetime::should_schedule_deactivation(std::time_t time) {
+bool RuleLifetime::should_schedule_deactivation(std::time_t time) const {
   return deactivation_time != 0 && time <= deactivation_time;
 }
 
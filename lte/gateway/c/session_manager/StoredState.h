@@ -13,12 +13,15 @@
 #pragma once
 
 #include <experimental/optional>
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <folly/dynamic.h>
 #include <folly/Format.h>
 #include <folly/json.h>
 #include <lte/protos/pipelined.grpc.pb.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 
+#include <array>
 #include <functional>
 #include <set>
 #include <string>
@@ -58,6 +61,7 @@ struct StoredChargingGrant {
 };
 
 typedef std::unordered_map<std::string, StoredMonitor> StoredMonitorMap;
+typedef folly::F14FastMap<std::string, RuleLifetime> RuleLifetimeMap;
 typedef std::unordered_map<
     CreditKey, StoredChargingGrant, decltype(&ccHash), decltype(&ccEqual)>
     StoredChargingCreditMap;
@@ -81,9 +85,9 @@ struct StoredSessionState {
   std::vector<std::string> static_rule_ids;
   std::vector<PolicyRule> dynamic_rules;
   std::vector<PolicyRule> gy_dynamic_rules;
-  std::set<std::string> scheduled_static_rules;
+  folly::F14FastSet<std::string> scheduled_static_rules;
   std::vector<PolicyRule> scheduled_dynamic_rules;
-  std::unordered_map<std::string, RuleLifetime> rule_lifetimes;
+  RuleLifetimeMap rule_lifetimes;
   uint32_t request_number;
   EventTriggerStatus pending_event_triggers;
   google::protobuf::Timestamp revalidation_time;
@@ -108,7 +112,9 @@ struct SessionCreditUpdateCriteria {
   GrantedUnits received_granted_units;
 
   // Do not mark REPORTING buckets, but do mark REPORTED
-  std::unordered_map<Bucket, uint64_t> bucket_deltas;
+  // indexed directly by Bucket; fixed-size so a credit update touches plain
+  // array slots instead of hashing each bucket
+  std::array<uint64_t, BUCKET_ENUM_MAX_VALUE> bucket_deltas{};
 
   bool deleted;
   bool report_last_credit;
@@ -140,13 +146,15 @@ struct SessionStateUpdateCriteria {
   // Map to maintain per-policy versions. Contains all values, not delta.
   optional<PolicyStatsMap> policy_version_and_stats;
 
-  std::set<std::string> static_rules_to_install;
-  std::set<std::string> static_rules_to_uninstall;
-  std::set<std::string> new_scheduled_static_rules;
+  // F14 sets: these carry a handful of rule IDs per update cycle and are
+  // written on every rule install/uninstall, so avoid a tree node per entry
+  folly::F14FastSet<std::string> static_rules_to_install;
+  folly::F14FastSet<std::string> static_rules_to_uninstall;
+  folly::F14FastSet<std::string> new_scheduled_static_rules;
   std::vector<PolicyRule> dynamic_rules_to_install;
   std::vector<PolicyRule> gy_dynamic_rules_to_install;
-  std::set<std::string> dynamic_rules_to_uninstall;
-  std::set<std::string> gy_dynamic_rules_to_uninstall;
+  folly::F14FastSet<std::string> dynamic_rules_to_uninstall;
+  folly::F14FastSet<std::string> gy_dynamic_rules_to_uninstall;
   std::vector<PolicyRule> new_scheduled_dynamic_rules;
   // Converged rules part of 5G rules
   bool clear_pdr_list;
@@ -166,8 +174,11 @@ struct SessionStateUpdateCriteria {
   magma::lte::SubscriberQuotaUpdate_Type updated_subscriber_quota_state;
 
   bool is_bearer_mapping_updated;
-  // Only valid if is_bearer_mapping_updated is true
-  BearerIDByPolicyID bearer_id_by_policy;
+  // Only valid if is_bearer_mapping_updated is true. Deltas against the
+  // session's policy -> bearer map, so a bind writes one entry instead of
+  // snapshotting the whole map
+  BearerIDByPolicyID bearer_id_by_policy_added;
+  std::vector<PolicyID> bearer_id_by_policy_removed;
   Teids teids;
 };
 
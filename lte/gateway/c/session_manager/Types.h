@@ -13,6 +13,7 @@
 #pragma once
 
 #include <experimental/optional>
+#include <folly/container/F14Map.h>
 #include <folly/dynamic.h>
 #include <folly/Format.h>
 #include <folly/json.h>
@@ -161,10 +162,10 @@ struct RuleLifetime {
       : activation_time(activation), deactivation_time(deactivation) {}
   explicit RuleLifetime(const StaticRuleInstall& rule_install);
   explicit RuleLifetime(const DynamicRuleInstall& rule_install);
-  bool is_within_lifetime(std::time_t time);
-  bool exceeded_lifetime(std::time_t time);
-  bool before_lifetime(std::time_t time);
-  bool should_schedule_deactivation(std::time_t time);
+  bool is_within_lifetime(std::time_t time) const;
+  bool exceeded_lifetime(std::time_t time) const;
+  bool before_lifetime(std::time_t time) const;
+  bool should_schedule_deactivation(std::time_t time) const;
 };
 
 // QoS Management
@@ -177,10 +178,8 @@ struct PolicyID {
   PolicyType policy_type;
   std::string rule_id;
 
-  PolicyID(PolicyType p_type, std::string r_id) {
-    policy_type = p_type;
-    rule_id     = r_id;
-  }
+  PolicyID(PolicyType p_type, std::string r_id)
+      : policy_type(p_type), rule_id(std::move(r_id)) {}
 
   bool operator==(const PolicyID& id) const {
     return rule_id == id.rule_id && policy_type == id.policy_type;
@@ -207,7 +206,9 @@ struct BearerIDAndTeid {
   }
 };
 
-typedef std::unordered_map<PolicyID, BearerIDAndTeid, PolicyIDHash>
+// F14's open-addressing layout keeps these small, lookup-heavy maps on a
+// cache line instead of chasing one heap node per entry
+typedef folly::F14FastMap<PolicyID, BearerIDAndTeid, PolicyIDHash>
     BearerIDByPolicyID;
 
 struct RuleToProcess {
@@ -2373,7 +2373,7 @@ TEST_F(LocalEnforcerTest, test_dedicated_bearer_lifecycle) {
       session_map, bearer_bind_req_fail, update);
   // Check update criteria has changes
   EXPECT_TRUE(update[IMSI1][SESSION_ID_1].is_bearer_mapping_updated);
-  EXPECT_EQ(update[IMSI1][SESSION_ID_1].bearer_id_by_policy.size(), 2);
+  EXPECT_EQ(update[IMSI1][SESSION_ID_1].bearer_id_by_policy_added.size(), 2);
   // Write + Read in/from SessionStore
   write_success = session_store->update_sessions(update);
   EXPECT_TRUE(write_success);
@@ -2422,7 +2422,8 @@ TEST_F(LocalEnforcerTest, test_dedicated_bearer_lifecycle) {
       session_map, update_response, update);
   // Check update criteria has changes + no bearer left!
   EXPECT_TRUE(update[IMSI1][SESSION_ID_1].is_bearer_mapping_updated);
-  EXPECT_EQ(update[IMSI1][SESSION_ID_1].bearer_id_by_policy.size(), 0);
+  EXPECT_EQ(update[IMSI1][SESSION_ID_1].bearer_id_by_policy_added.size(), 0);
+  EXPECT_EQ(update[IMSI1][SESSION_ID_1].bearer_id_by_policy_removed.size(), 1);
 }
 
 // Test the handle_set_session_rules function to apply rules to sessions
@@ -3561,6 +3562,51 @@ TEST_F(LocalEnforcerTest, test_receiving_stats_for_subset_of_rules) {
   EXPECT_EQ(1, session_map[IMSI1][0]->get_current_rule_version("rule2"));
 }
 
+TEST_F(LocalEnforcerTest, test_rule_timer_wheel) {
+  // Delays of a second or more never touch the event base, so the wheel can
+  // be driven tick-by-tick without attach
+  RuleTimerWheel wheel;
+
+  // A 1500 ms timer must not fire before 1500 ms have elapsed. The first
+  // tick after insert can land almost immediately, so the wheel may only
+  // fire it from the third tick on.
+  int fired_short = 0;
+  wheel.insert(std::chrono::milliseconds(1500), [&] { fired_short++; });
+  wheel.tick();
+  wheel.tick();
+  EXPECT_EQ(fired_short, 0);
+  wheel.tick();
+  EXPECT_EQ(fired_short, 1);
+
+  // Exactly one wheel revolution (4096 s) wraps past the insertion slot and
+  // must wait out the extra round, firing on tick 4097, not a revolution
+  // early or late
+  int fired_revolution = 0;
+  wheel.insert(
+      std::chrono::milliseconds(4096 * 1000), [&] { fired_revolution++; });
+  // A multi-revolution timer (2 * 4096 s) keeps its callback pending across
+  // two passes over its slot
+  int fired_multi = 0;
+  wheel.insert(
+      std::chrono::milliseconds(2 * 4096 * 1000), [&] { fired_multi++; });
+  for (int i = 0; i < 4096; i++) {
+    wheel.tick();
+  }
+  EXPECT_EQ(fired_revolution, 0);
+  wheel.tick();
+  EXPECT_EQ(fired_revolution, 1);
+  for (int i = 0; i < 4095; i++) {
+    wheel.tick();
+  }
+  EXPECT_EQ(fired_multi, 0);
+  wheel.tick();
+  EXPECT_EQ(fired_multi, 1);
+
+  // Short timers must not re-fire on later revolutions
+  EXPECT_EQ(fired_short, 1);
+  EXPECT_EQ(fired_revolution, 1);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   FLAGS_logtostderr = 1;
@@ -1069,16 +1069,15 @@ TEST_F(SessionStateTest, test_process_static_rule_installs) {
   session_state->activate_static_rule("static-qos-3", lifetime, nullptr);
 
   // Create a StaticRuleInstall with all four rules above
-  std::vector<StaticRuleInstall> rule_installs{
-      // should be ignored as it is already active
-      create_static_rule_install("static-1"),
-      // new non-qos rule
-      create_static_rule_install("static-2"),
-      // should be ignored as it is already active
-      create_static_rule_install("static-qos-3"),
-      // new qos rule
-      create_static_rule_install("static-qos-4"),
-  };
+  google::protobuf::RepeatedPtrField<StaticRuleInstall> rule_installs;
+  // should be ignored as it is already active
+  *rule_installs.Add() = create_static_rule_install("static-1");
+  // new non-qos rule
+  *rule_installs.Add() = create_static_rule_install("static-2");
+  // should be ignored as it is already active
+  *rule_installs.Add() = create_static_rule_install("static-qos-3");
+  // new qos rule
+  *rule_installs.Add() = create_static_rule_install("static-qos-4");
   RulesToProcess pending_activation, pending_deactivation, pending_bearer_setup;
   RulesToSchedule pending_scheduling;
   session_state->process_static_rule_installs(
@@ -1106,16 +1105,15 @@ TEST_F(SessionStateTest, test_process_dynamic_rule_installs) {
   session_state->insert_dynamic_rule(dynamic_qos_3, lifetime, nullptr);
 
   // Create a StaticRuleInstall with all four rules above
-  std::vector<DynamicRuleInstall> rule_installs{
-      // should be installed even though it is already active
-      create_dynamic_rule_install(dynamic_1),
-      // new non-qos rule
-      create_dynamic_rule_install(dynamic_2),
-      // should be installed even though it is already active
-      create_dynamic_rule_install(dynamic_qos_3),
-      // new qos rule
-      create_dynamic_rule_install(dynamic_qos_4),
-  };
+  google::protobuf::RepeatedPtrField<DynamicRuleInstall> rule_installs;
+  // should be installed even though it is already active
+  *rule_installs.Add() = create_dynamic_rule_install(dynamic_1);
+  // new non-qos rule
+  *rule_installs.Add() = create_dynamic_rule_install(dynamic_2);
+  // should be installed even though it is already active
+  *rule_installs.Add() = create_dynamic_rule_install(dynamic_qos_3);
+  // new qos rule
+  *rule_installs.Add() = create_dynamic_rule_install(dynamic_qos_4);
   RulesToProcess pending_activation, pending_deactivation, pending_bearer_setup;
   RulesToSchedule pending_scheduling;
   session_state->process_dynamic_rule_installs(
@@ -145,7 +145,7 @@ class SessionStoreTest : public ::testing::Test {
     auto update_criteria = SessionStateUpdateCriteria{};
 
     // Rule installation
-    update_criteria.static_rules_to_install = std::set<std::string>{};
+    update_criteria.static_rules_to_install = folly::F14FastSet<std::string>{};
     update_criteria.static_rules_to_install.insert(rule_id_1);
     update_criteria.dynamic_rules_to_install = std::vector<PolicyRule>{};
     PolicyRule policy                        = get_dynamic_rule();
@@ -181,7 +181,7 @@ class SessionStoreTest : public ::testing::Test {
     SessionCreditUpdateCriteria monitoring_update{};
     monitoring_update.reauth_state     = REAUTH_NOT_NEEDED;
     monitoring_update.expiry_time      = 0;
-    auto bucket_deltas                 = std::unordered_map<Bucket, uint64_t>{};
+    auto bucket_deltas = std::array<uint64_t, BUCKET_ENUM_MAX_VALUE>{};
     bucket_deltas[USED_TX]             = 111;
     bucket_deltas[USED_RX]             = 333;
     bucket_deltas[ALLOWED_TOTAL]       = 2;
@@ -31,11 +31,37 @@
 #ifndef LOG_WITH_GLOG
 #include <iostream>
 
-// for non glog use cases, just log to std cout
+// Highest verbosity that is actually emitted; messages above it are
+// discarded without evaluating the streamed expressions, mirroring glog's
+// VLOG semantics
+#ifndef MAGMA_LOG_VERBOSITY
+#define MAGMA_LOG_VERBOSITY MDEBUG
+#endif
+
+// for non glog use cases, just log to std cout. Lines end with '\n' rather
+// than std::endl so every message does not force a flush
 struct _MLOG_NEWLINE {
-  ~_MLOG_NEWLINE() { std::cout << std::endl; }
+  ~_MLOG_NEWLINE() { std::cout << "\n"; }
+};
+// Binds looser than operator<< so the whole stream chain is swallowed when
+// the verbosity is disabled
+struct _MLOG_VOIDIFY {
+  void operator&(std::ostream&) {}
 };
 #define MLOG(VERBOSITY)                                                        \
-  (_MLOG_NEWLINE(), std::cout << "[" << __FILE__ << ":" << __LINE__ << "] ")
+  ((VERBOSITY) > MAGMA_LOG_VERBOSITY)                                          \
+      ? (void)0                                                                \
+      : _MLOG_VOIDIFY() & (_MLOG_NEWLINE(),                                    \
+                           std::cout << "[" << __FILE__ << ":" << __LINE__     \
+                                     << "] ")
+
+// Matches the glog branch's MLOG_IF: the streamed expressions are only
+// evaluated when both the verbosity is enabled and the condition holds
+#define MLOG_IF(VERBOSITY, CONDITION)                                          \
+  (((VERBOSITY) > MAGMA_LOG_VERBOSITY) || !(CONDITION))                        \
+      ? (void)0                                                                \
+      : _MLOG_VOIDIFY() & (_MLOG_NEWLINE(),                                    \
+                           std::cout << "[" << __FILE__ << ":" << __LINE__     \
+                                     << "] ")
 
 #endif
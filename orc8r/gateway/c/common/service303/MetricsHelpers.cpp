@@ -33,6 +33,18 @@ void increment_counter(
   va_end(ap);
 }
 
+void increment_counter_pair(
+    const char* name, const char* pair_label, const char* value_a,
+    double increment_a, const char* value_b, double increment_b, size_t n_labels,
+    ...) {
+  va_list ap;
+  va_start(ap, n_labels);
+  MetricsSingleton::Instance().IncrementCounterPair(
+      name, pair_label, value_a, increment_a, value_b, increment_b, n_labels,
+      ap);
+  va_end(ap);
+}
+
 void remove_gauge(const char* name, size_t n_labels, ...) {
   va_list ap;
   va_start(ap, n_labels);
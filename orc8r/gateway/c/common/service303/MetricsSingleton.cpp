@@ -69,6 +69,18 @@ void MetricsSingleton::IncrementCounter(
   counters_.Get(name, labels).Increment(increment);
 }
 
+void MetricsSingleton::IncrementCounterPair(
+    const char* name, const char* pair_label, const char* value_a,
+    double increment_a, const char* value_b, double increment_b,
+    size_t label_count, va_list& args) {
+  std::map<std::string, std::string> labels;
+  args_to_map(labels, label_count, args);
+  labels[pair_label] = value_a;
+  counters_.Get(name, labels).Increment(increment_a);
+  labels[pair_label] = value_b;
+  counters_.Get(name, labels).Increment(increment_b);
+}
+
 void MetricsSingleton::RemoveGauge(
     const char* name, size_t label_count, va_list& args) {
   std::map<std::string, std::string> labels;
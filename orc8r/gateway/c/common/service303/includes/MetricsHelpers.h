@@ -36,6 +36,22 @@ void remove_counter(const char* name, size_t n_labels, ...);
 void increment_counter(
     const char* name, double increment, size_t n_labels, ...);
 
+/**
+ * Increments two Counter series of the same family that differ only in the
+ * value of pair_label (e.g. direction=up/down). The shared labels are parsed
+ * once for both increments.
+ * @param name
+ * @param pair_label label whose value distinguishes the two series
+ * @param value_a / increment_a first series label value and increment
+ * @param value_b / increment_b second series label value and increment
+ * @param n_labels number of shared labels
+ * @param ... shared label args (name, value)
+ */
+void increment_counter_pair(
+    const char* name, const char* pair_label, const char* value_a,
+    double increment_a, const char* value_b, double increment_b,
+    size_t n_labels, ...);
+
 /**
  * Remove the gauge metric that matches name+labels given
  * @param name
@@ -79,6 +79,12 @@ class MetricsSingleton {
   void RemoveCounter(const char* name, size_t label_count, va_list& args);
   void IncrementCounter(
       const char* name, double increment, size_t label_count, va_list& args);
+  // Increment two series of the same family that differ only in one label
+  // (e.g. direction=up/down), parsing the shared labels a single time
+  void IncrementCounterPair(
+      const char* name, const char* pair_label, const char* value_a,
+      double increment_a, const char* value_b, double increment_b,
+      size_t label_count, va_list& args);
   void RemoveGauge(const char* name, size_t label_count, va_list& args);
   void IncrementGauge(
       const char* name, double increment, size_t label_count, va_list& args);